@@ -0,0 +1,89 @@
+#include <Geegrow_TCS34725.h>
+
+#define ITERATIONS   1000
+
+Geegrow_TCS34725* color_dev;
+/* Calibration table is owned by sketch */
+Geegrow_TCS34725_CalibStorage<4> calib_table;
+
+RGBC_value_t arr[4] = {
+  {3300, 3400, 3300, 10000},
+  {1800, 2300, 1900, 6000},
+  {290, 400, 300, 1000},
+  {150, 180, 160, 500},
+};
+
+/* Same conversion done with float math */
+void convertFloat(const RGBC_value_t *calib, uint8_t size, const RGBC_value_t &value, int16_t &red, int16_t &green, int16_t &blue) {
+  if (value.clear == 0) {
+    red = green = blue = 0;
+    return;
+  }
+  uint8_t lo = 0, hi = 0;
+  float pos = 0;
+  if (value.clear <= calib[size - 1].clear) {
+    lo = hi = size - 1;
+  } else if (value.clear < calib[0].clear) {
+    while (calib[hi].clear > value.clear)
+      hi++;
+    lo = hi - 1;
+    pos = (float)(calib[lo].clear - value.clear) / (calib[lo].clear - calib[hi].clear);
+  }
+  float r = 255.0 / calib[lo].red   + (255.0 / calib[hi].red   - 255.0 / calib[lo].red)   * pos;
+  float g = 255.0 / calib[lo].green + (255.0 / calib[hi].green - 255.0 / calib[lo].green) * pos;
+  float b = 255.0 / calib[lo].blue  + (255.0 / calib[hi].blue  - 255.0 / calib[lo].blue)  * pos;
+  red   = constrain(value.red   * r, 0, 255);
+  green = constrain(value.green * g, 0, 255);
+  blue  = constrain(value.blue  * b, 0, 255);
+}
+
+void setup() {
+  Serial.begin(9600);
+  while(!Serial);
+  color_dev = new Geegrow_TCS34725(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+  color_dev->setCalibrationStorage(calib_table);
+  color_dev->calibrateManual(arr, 4);
+
+  uint8_t size;
+  const RGBC_value_t* calib = color_dev->getCalibrationValues(size);
+  RGBC_value_t value;
+  int16_t red, green, blue;
+  int16_t red_f, green_f, blue_f;
+  int16_t maxError = 0;
+
+  /* Accuracy against float path */
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    value.clear = random(1, 12000);
+    value.red   = random(0, 1500);
+    value.green = random(0, 1500);
+    value.blue  = random(0, 1500);
+    color_dev->convertRGB_255(value, red, green, blue);
+    convertFloat(calib, size, value, red_f, green_f, blue_f);
+    maxError = max(maxError, abs(red - red_f));
+    maxError = max(maxError, abs(green - green_f));
+    maxError = max(maxError, abs(blue - blue_f));
+  }
+
+  /* Timing of both paths */
+  value = {1200, 900, 700, 3000};
+  uint32_t start = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    value.clear = 3000 + (i & 0xFF);
+    color_dev->convertRGB_255(value, red, green, blue);
+  }
+  uint32_t fixedTime = micros() - start;
+
+  start = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    value.clear = 3000 + (i & 0xFF);
+    convertFloat(calib, size, value, red_f, green_f, blue_f);
+  }
+  uint32_t floatTime = micros() - start;
+
+  Serial.print("Fixed-point, ns per conversion: "); Serial.println(fixedTime * 1000 / ITERATIONS);
+  Serial.print("Float, ns per conversion: "); Serial.println(floatTime * 1000 / ITERATIONS);
+  Serial.print("Max difference, LSB: "); Serial.println(maxError);
+}
+
+void loop() {
+}
\ No newline at end of file
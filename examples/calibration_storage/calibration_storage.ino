@@ -0,0 +1,40 @@
+#include <Geegrow_TCS34725.h>
+
+/* Address of calibration blob in EEPROM */
+#define CALIB_ADDRESS   0
+
+Geegrow_TCS34725* color_dev;
+/* Calibration table is owned by sketch */
+Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> calib_table;
+
+void setup() {
+  Serial.begin(9600);
+  while(!Serial);
+  color_dev = new Geegrow_TCS34725(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+  color_dev->setCalibrationStorage(calib_table);
+
+#if TCS34725_HAS_EEPROM
+  /* Calibrate only if there is no valid calibration for this configuration */
+  if (color_dev->loadCalibration(CALIB_ADDRESS)) {
+    Serial.println("Calibration loaded from EEPROM");
+  } else {
+    color_dev->calibrate();
+    color_dev->saveCalibration(CALIB_ADDRESS);
+    Serial.println("Calibration saved to EEPROM");
+  }
+#else
+  /* No EEPROM support on this core, keep blob with writeCalibration() */
+  color_dev->calibrate();
+  Serial.print("Calibration blob size: ");
+  Serial.println(color_dev->getCalibrationBlobSize());
+#endif
+}
+
+void loop() {
+  int16_t red = 0, green = 0, blue = 0;
+  color_dev->getRGB_255(red, green, blue);
+  Serial.print("R: "); Serial.print(red);
+  Serial.print(" G: "); Serial.print(green);
+  Serial.print(" B: "); Serial.print(blue);
+  Serial.println();
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include <Geegrow_TCS34725.h>
+
+/* INT pin of the sensor, must support external interrupts */
+#define INT_PIN   7
+
+/* Thresholds below are derived from the same configuration as the device */
+typedef Geegrow_TCS34725_Config<RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X> SensorConfig;
+
+Geegrow_TCS34725* color_dev;
+Geegrow_TCS34725_StaticSampleBuffer<4> samples;
+
+void sensorISR() {
+  color_dev->onInterrupt();
+}
+
+void setup() {
+  Serial.begin(9600);
+  while(!Serial);
+  color_dev = new Geegrow_TCS34725(SensorConfig());
+
+  /* INT output of the sensor is open-drain, active low */
+  pinMode(INT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(INT_PIN), sensorISR, FALLING);
+
+  /* Wake up when clear value moves by more than 1/32 of full scale */
+  color_dev->enableChangeDetection(samples, SensorConfig::saturation / 32, RN_PERS_CONSEQ_VAL_1);
+}
+
+void loop() {
+  RGBC_value_t value;
+
+  color_dev->processIRQ();
+  while (color_dev->readSample(value)) {
+    Serial.print("Scene changed, Clear: "); Serial.print(value.clear);
+    Serial.print(" R: "); Serial.print(value.red);
+    Serial.print(" G: "); Serial.print(value.green);
+    Serial.print(" B: "); Serial.print(value.blue);
+    Serial.println();
+  }
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include <Geegrow_TCS34725.h>
+
+Geegrow_TCS34725* color_dev;
+/* Converter follows gain and integration time of the sensor */
+Geegrow_TCS34725_Color color;
+
+void setup() {
+  Serial.begin(9600);
+  while(!Serial);
+  color_dev = new Geegrow_TCS34725(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+  color_dev->setColor(&color);
+
+  /* White point for L*a*b*, taken from a white sample */
+  Serial.println("Bring a white sample to the sensor in 5 sec");
+  delay(5000);
+  RGBC_value_t value;
+  Color_XYZ_t white;
+  color_dev->getRawData(value);
+  color.toXYZ(value, white);
+  color.setWhitePoint(white);
+}
+
+void loop() {
+  RGBC_value_t value;
+  Color_Lab_t lab;
+  Color_HSV_t hsv;
+
+  if (color_dev->getRawData(value) != TCS34725_OK)
+    return;
+  if (color.isSaturated(value)) {
+    Serial.println("Saturated");
+    return;
+  }
+  color.toLab(value, lab);
+  color.toHSV(value, hsv);
+
+  Serial.print("Lux: "); Serial.print(color.getLux(value) / (float)COLOR_LUX_SCALE);
+  Serial.print(" CCT: "); Serial.print(color.getCCT(value));
+  Serial.print(" L: "); Serial.print(lab.L / 100.0);
+  Serial.print(" a: "); Serial.print(lab.a / 100.0);
+  Serial.print(" b: "); Serial.print(lab.b / 100.0);
+  Serial.print(" H: "); Serial.print(hsv.hue);
+  Serial.print(" S: "); Serial.print(hsv.saturation);
+  Serial.print(" V: "); Serial.print(hsv.value);
+  Serial.println();
+}
\ No newline at end of file
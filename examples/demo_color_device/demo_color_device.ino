@@ -5,6 +5,8 @@
 #define B_PIN   9
 
 Geegrow_TCS34725* color_dev;
+/* Calibration table is owned by sketch */
+Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> calib_table;
 
 void setup() {
   pinMode(R_PIN, OUTPUT);
@@ -14,6 +16,7 @@ void setup() {
   Serial.begin(9600);
   while(!Serial);
   color_dev = new Geegrow_TCS34725(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+  color_dev->setCalibrationStorage(calib_table);
 
   /* Auto-calibration */
   color_dev->calibrate();
@@ -39,7 +42,10 @@ void loop() {
 //  Serial.print(" Clear: "); Serial.print(cl);
 //  Serial.println();
 
-  color_dev->getRGB_255(red, green, blue);
+  if (color_dev->getRGB_255(red, green, blue) != TCS34725_OK) {
+    Serial.print("Sensor error: "); Serial.println(color_dev->getLastError());
+    return;
+  }
   Serial.print("R: "); Serial.print(red);
   Serial.print(" G: "); Serial.print(green);
   Serial.print(" B: "); Serial.print(blue);
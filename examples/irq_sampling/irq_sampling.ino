@@ -0,0 +1,41 @@
+#include <Geegrow_TCS34725.h>
+
+/* INT pin of the sensor, must support external interrupts */
+#define INT_PIN   7
+
+Geegrow_TCS34725* color_dev;
+/* Samples collected between calls of loop() */
+Geegrow_TCS34725_StaticSampleBuffer<8> samples;
+
+void sensorISR() {
+  color_dev->onInterrupt();
+}
+
+void setup() {
+  Serial.begin(9600);
+  while(!Serial);
+  color_dev = new Geegrow_TCS34725(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+
+  /* INT output of the sensor is open-drain, active low */
+  pinMode(INT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(INT_PIN), sensorISR, FALLING);
+
+  /* Interrupt on every integration cycle */
+  color_dev->beginInterruptMode(samples, RN_PERS_CONSEQ_VAL_0);
+}
+
+void loop() {
+  RGBC_value_t value;
+  uint16_t overflow, missed;
+
+  color_dev->processIRQ();
+  while (color_dev->readSample(value)) {
+    Serial.print("R: "); Serial.print(value.red);
+    Serial.print(" G: "); Serial.print(value.green);
+    Serial.print(" B: "); Serial.print(value.blue);
+    Serial.print(" Clear: "); Serial.print(value.clear);
+    color_dev->getDroppedSamples(overflow, missed);
+    Serial.print(" Dropped: "); Serial.print(overflow + missed);
+    Serial.println();
+  }
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include <Geegrow_TCS34725.h>
+#include <Geegrow_TCS34725_Array.h>
+
+#define SENSORS_COUNT   4
+
+/* Sensors have the same address, so they are connected to channels of TCA9548A */
+Geegrow_TCS34725_WireBus wireBus(Wire);
+Geegrow_TCS34725_Mux mux(wireBus, 0x70);
+Geegrow_TCS34725_MuxBus channels[SENSORS_COUNT] = {
+  Geegrow_TCS34725_MuxBus(mux, 0),
+  Geegrow_TCS34725_MuxBus(mux, 1),
+  Geegrow_TCS34725_MuxBus(mux, 2),
+  Geegrow_TCS34725_MuxBus(mux, 3),
+};
+
+Geegrow_TCS34725* sensors[SENSORS_COUNT];
+Geegrow_TCS34725_Array* array;
+
+void setup() {
+  Serial.begin(9600);
+  while(!Serial);
+  for (uint8_t i = 0; i < SENSORS_COUNT; i++)
+    sensors[i] = new Geegrow_TCS34725(channels[i], TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+  array = new Geegrow_TCS34725_Array(sensors, SENSORS_COUNT);
+  array->begin();
+}
+
+void loop() {
+  uint8_t index;
+  RGBC_value_t value;
+
+  /* Other work may be done here, poll() never waits for integration */
+  if (array->poll(index, value)) {
+    Serial.print("Sensor "); Serial.print(index);
+    Serial.print(" R: "); Serial.print(value.red);
+    Serial.print(" G: "); Serial.print(value.green);
+    Serial.print(" B: "); Serial.print(value.blue);
+    Serial.print(" Clear: "); Serial.print(value.clear);
+    Serial.println();
+  }
+}
\ No newline at end of file
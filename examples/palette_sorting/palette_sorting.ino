@@ -0,0 +1,49 @@
+#include <Geegrow_TCS34725.h>
+#include <Geegrow_TCS34725_Palette.h>
+
+/* Number of colour classes to be taught */
+#define CLASSES   4
+
+/* Lookup table of 2 bits per channel has 64 cells, candidate list of
+   64 * CLASSES entries fits any palette */
+Geegrow_TCS34725* color_dev;
+/* Calibration table is owned by sketch */
+Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> calib_table;
+Geegrow_TCS34725_StaticPalette<CLASSES, 2, 64 * CLASSES> palette;
+
+void setup() {
+  Serial.begin(9600);
+  while(!Serial);
+  color_dev = new Geegrow_TCS34725(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+  color_dev->setCalibrationStorage(calib_table);
+  color_dev->calibrate();
+
+  /* Reference colours are captured through the calibrated path */
+  int16_t red, green, blue;
+  for (uint8_t i = 0; i < CLASSES; i++) {
+    Serial.print("Bring a part of class "); Serial.print(i); Serial.println(" to the sensor in 5 sec");
+    delay(5000);
+    color_dev->getRGB_255(red, green, blue);
+    palette.add(red, green, blue);
+  }
+  palette.build();
+
+  /* Reject parts far from all classes or between two of them */
+  palette.setReject(40, 8);
+}
+
+void loop() {
+  int16_t red, green, blue;
+  uint8_t margin;
+
+  if (color_dev->getRGB_255(red, green, blue) != TCS34725_OK)
+    return;
+  uint8_t id = palette.classify(red, green, blue, margin);
+  if (id == PALETTE_REJECT) {
+    Serial.println("Rejected");
+  } else {
+    Serial.print("Class: "); Serial.print(id);
+    Serial.print(" Margin: "); Serial.print(margin);
+    Serial.println();
+  }
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include <Geegrow_TCS34725.h>
+
+Geegrow_TCS34725* color_dev;
+/* Records wait in 64 bytes of RAM until Serial accepts them */
+Geegrow_TCS34725_StaticTraceWriter<64> trace;
+
+void setup() {
+  Serial.begin(115200);
+  while(!Serial);
+  color_dev = new Geegrow_TCS34725(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+  color_dev->setAutoRange(true);
+
+  /* Binary trace goes to Serial, capture it to a file on host and replay
+     it with extras/host tcs34725_replay -a, or with
+     Geegrow_TCS34725_TraceReader on a driver created with NullBus */
+  trace.begin(Serial);
+  color_dev->setTraceWriter(&trace);
+}
+
+void loop() {
+  RGBC_value_t value;
+
+  /* Every sample read by driver is recorded */
+  color_dev->readIfReady(value);
+  /* Sends recorded bytes without waiting for Serial */
+  trace.poll();
+}
\ No newline at end of file
@@ -0,0 +1,270 @@
+/*!
+ * @file bench.cpp
+ *
+ * Benchmark of TCS34725 library on host against simulated device.
+ * Bus cost and virtual time are exact for the simulated 100 kHz bus,
+ * CPU time is measured on host and is useful only to compare revisions
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include <stdio.h>
+#include <chrono>
+#include <Geegrow_TCS34725.h>
+#include <Geegrow_TCS34725_Palette.h>
+#include "TCS34725_Sim.h"
+
+#define BENCH_SAMPLES       100
+#define BENCH_CPU_LOOPS     200000
+
+static Geegrow_TCS34725 *sensor = nullptr;
+
+static void sensorIsr() {
+    sensor->onInterrupt();
+}
+
+/* Snapshot of counters at the start of measured section */
+struct Section {
+    uint64_t time;
+    Host_WireStats_t bus;
+
+    void begin() {
+        Wire.resetStats();
+        this->time = Host::now();
+    }
+
+    void report(const char *name, uint32_t samples) {
+        Wire.getStats(this->bus);
+        uint64_t elapsed = Host::now() - this->time;
+        if (samples == 0)
+            samples = 1;
+        printf("%-34s %8u %10.2f %10.2f %12.1f %12.1f\n", name, samples,
+            (double)this->bus.transactions / samples, (double)this->bus.bytes / samples,
+            (double)this->bus.busTime / samples, (double)elapsed / samples);
+    }
+};
+
+static void setupDevice(TCS34725_Sim &sim) {
+    Host::reset();
+    Wire.detachAll();
+    Wire.setClock(100000);
+    sim.powerCycle();
+    sim.setScene(100, 40, 33, 27);
+    sim.attach(Wire);
+}
+
+static void benchBlocking() {
+    TCS34725_Sim sim;
+    setupDevice(sim);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Section s;
+    s.begin();
+    RGBC_value_t value;
+    for (uint16_t i = 0; i < BENCH_SAMPLES; i++)
+        tcs.getRawData(value);
+    s.report("getRawData, 24 ms", BENCH_SAMPLES);
+}
+
+static void benchPolling() {
+    TCS34725_Sim sim;
+    setupDevice(sim);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Section s;
+    s.begin();
+    RGBC_value_t value;
+    uint16_t samples = 0;
+    while (samples < BENCH_SAMPLES) {
+        if (tcs.readIfReady(value))
+            samples++;
+        delayMicroseconds(100);
+    }
+    s.report("readIfReady, 24 ms", samples);
+}
+
+static void benchPeriodic() {
+    TCS34725_Sim sim;
+    setupDevice(sim);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    tcs.setSamplePeriod(500000UL);
+    Section s;
+    s.begin();
+    RGBC_value_t value;
+    uint16_t samples = 0;
+    while (samples < BENCH_SAMPLES / 10) {
+        if (tcs.readIfReady(value))
+            samples++;
+        delay(1);
+    }
+    s.report("readIfReady, 500 ms period", samples);
+}
+
+static void benchInterrupt() {
+    TCS34725_Sim sim;
+    setupDevice(sim);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    sensor = &tcs;
+    sim.setIsr(sensorIsr);
+    Geegrow_TCS34725_StaticSampleBuffer<8> buffer;
+    tcs.beginInterruptMode(buffer);
+    Section s;
+    s.begin();
+    RGBC_value_t value;
+    uint16_t samples = 0;
+    while (samples < BENCH_SAMPLES) {
+        tcs.processIRQ();
+        while (tcs.readSample(value))
+            samples++;
+        delayMicroseconds(100);
+    }
+    s.report("processIRQ, every cycle", samples);
+    tcs.endInterruptMode();
+}
+
+static void benchChangeDetection() {
+    TCS34725_Sim sim;
+    setupDevice(sim);
+    sim.setNoise(20);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    sensor = &tcs;
+    sim.setIsr(sensorIsr);
+    Geegrow_TCS34725_StaticSampleBuffer<4> buffer;
+    tcs.enableChangeDetection(buffer, 200, RN_PERS_CONSEQ_VAL_2);
+    Section s;
+    s.begin();
+    RGBC_value_t value;
+    uint16_t samples = 0;
+    /* 10 s of static scene with one step change in the middle */
+    for (uint16_t ms = 0; ms < 10000; ms++) {
+        if (ms == 5000)
+            sim.setScene(200, 80, 66, 54);
+        tcs.processIRQ();
+        while (tcs.readSample(value))
+            samples++;
+        delay(1);
+    }
+    s.report("change detection, 10 s", samples);
+    tcs.disableChangeDetection();
+}
+
+/* Same conversion as convertRGB_255 done in float, as on a core with FPU */
+static void convertFloat(const RGBC_value_t *calib, uint8_t size, const RGBC_value_t &value, int16_t *out) {
+    if (value.clear == 0) {
+        out[0] = out[1] = out[2] = 0;
+        return;
+    }
+    uint8_t lo = 0, hi = 0;
+    float pos = 0;
+    if (value.clear <= calib[size - 1].clear) {
+        lo = hi = size - 1;
+    } else if (value.clear < calib[0].clear) {
+        while (calib[hi].clear > value.clear)
+            hi++;
+        lo = hi - 1;
+        pos = (float)(calib[lo].clear - value.clear) / (calib[lo].clear - calib[hi].clear);
+    }
+    const uint16_t raw[3] = {value.red, value.green, value.blue};
+    const uint16_t refLo[3] = {calib[lo].red, calib[lo].green, calib[lo].blue};
+    const uint16_t refHi[3] = {calib[hi].red, calib[hi].green, calib[hi].blue};
+    for (uint8_t ch = 0; ch < 3; ch++) {
+        float t = raw[ch] * ((1 - pos) * 255.0f / refLo[ch] + pos * 255.0f / refHi[ch]);
+        out[ch] = (t > 255) ? 255 : (int16_t)t;
+    }
+}
+
+static void reportCpu(const char *name, std::chrono::steady_clock::time_point start, uint32_t loops) {
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    printf("%-34s %10.1f ns\n", name, ns / loops);
+}
+
+static void benchCpu() {
+    TCS34725_Sim sim;
+    setupDevice(sim);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> storage;
+    tcs.setCalibrationStorage(storage);
+    RGBC_value_t table[CALIB_TABLE_SIZE];
+    for (uint8_t i = 0; i < CALIB_TABLE_SIZE; i++) {
+        uint16_t clear = 9000 - i * 800;
+        table[i] = {(uint16_t)(clear * 2 / 5), (uint16_t)(clear / 3), (uint16_t)(clear / 4), clear};
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < BENCH_CPU_LOOPS / 100; i++)
+        tcs.calibrateManual(table, CALIB_TABLE_SIZE);
+    reportCpu("calibrateManual, full table", start, BENCH_CPU_LOOPS / 100);
+
+    volatile int32_t sink = 0;
+    int16_t red, green, blue;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < BENCH_CPU_LOOPS; i++) {
+        uint16_t clear = 500 + (i * 37) % 9000;
+        RGBC_value_t value = {(uint16_t)(clear / 3), (uint16_t)(clear / 3), (uint16_t)(clear / 4), clear};
+        tcs.convertRGB_255(value, red, green, blue);
+        sink += red + green + blue;
+    }
+    reportCpu("convertRGB_255", start, BENCH_CPU_LOOPS);
+
+    uint8_t size;
+    const RGBC_value_t *calib = tcs.getCalibrationValues(size);
+    int16_t out[3];
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < BENCH_CPU_LOOPS; i++) {
+        uint16_t clear = 500 + (i * 37) % 9000;
+        RGBC_value_t value = {(uint16_t)(clear / 3), (uint16_t)(clear / 3), (uint16_t)(clear / 4), clear};
+        convertFloat(calib, size, value, out);
+        sink += out[0] + out[1] + out[2];
+    }
+    reportCpu("convertRGB_255 in float", start, BENCH_CPU_LOOPS);
+
+    Geegrow_TCS34725_Color color;
+    tcs.setColor(&color);
+    Color_Lab_t lab;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < BENCH_CPU_LOOPS; i++) {
+        uint16_t clear = 500 + (i * 37) % 9000;
+        RGBC_value_t value = {(uint16_t)(clear / 3), (uint16_t)(clear / 3), (uint16_t)(clear / 4), clear};
+        sink += color.getLux(value) + color.getCCT(value);
+        color.toLab(value, lab);
+        sink += lab.L;
+    }
+    reportCpu("getLux + getCCT + toLab", start, BENCH_CPU_LOOPS);
+    (void)sink;
+}
+
+static void benchPalette(Geegrow_TCS34725_Palette &palette, const char *name) {
+    randomSeed(18);
+    while (palette.add(random(256), random(256), random(256)) != PALETTE_REJECT);
+    palette.build();
+    volatile int32_t sink = 0;
+    uint8_t margin;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < BENCH_CPU_LOOPS; i++)
+        sink += palette.classify(i * 37 % 256, i * 101 % 256, i * 211 % 256, margin);
+    reportCpu(name, start, BENCH_CPU_LOOPS);
+    (void)sink;
+}
+
+static void benchPalettes() {
+    static Geegrow_TCS34725_StaticPalette<8, 2, 512> palette8;
+    static Geegrow_TCS34725_StaticPalette<64, 3, 8192> palette64;
+    static Geegrow_TCS34725_StaticPalette<255, 4, 65535> palette255;
+    benchPalette(palette8, "classify, 8 classes, 2 bits");
+    benchPalette(palette64, "classify, 64 classes, 3 bits");
+    benchPalette(palette255, "classify, 255 classes, 4 bits");
+}
+
+int main() {
+    Serial.mute(true);
+    printf("%-34s %8s %10s %10s %12s %12s\n", "bus, per sample", "samples", "transact", "bytes", "bus us", "time us");
+    benchBlocking();
+    benchPolling();
+    benchPeriodic();
+    benchInterrupt();
+    benchChangeDetection();
+    printf("\n%-34s %13s\n", "CPU, per call", "host time");
+    benchCpu();
+    benchPalettes();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,175 @@
+/*!
+ * @file Arduino.cpp
+ *
+ * Host implementation of Arduino core: virtual time, interrupts, Serial
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+
+#define MAX_LISTENERS    8
+
+static uint64_t virtualTime = 0;
+static uint32_t callCost = 1;
+static bool interruptsEnabled = true;
+static Host::Isr pendingIsr = nullptr;
+static Host::TimeListener listeners[MAX_LISTENERS];
+static void *listenerCtx[MAX_LISTENERS];
+static uint8_t listenerCount = 0;
+static bool notifying = false;
+static uint32_t randomState = 1;
+
+HardwareSerial Serial;
+
+void Host::reset() {
+    virtualTime = 0;
+    callCost = 1;
+    interruptsEnabled = true;
+    pendingIsr = nullptr;
+    listenerCount = 0;
+}
+
+uint64_t Host::now() {
+    return virtualTime;
+}
+
+void Host::advance(uint32_t us) {
+    virtualTime += us;
+    /* Listeners may read time themselves, don't notify recursively */
+    if (notifying)
+        return;
+    notifying = true;
+    for (uint8_t i = 0; i < listenerCount; i++)
+        listeners[i](listenerCtx[i], virtualTime);
+    notifying = false;
+}
+
+void Host::setCallCost(uint32_t us) {
+    callCost = us;
+}
+
+void Host::addTimeListener(TimeListener listener, void *ctx) {
+    if (listenerCount < MAX_LISTENERS) {
+        listeners[listenerCount] = listener;
+        listenerCtx[listenerCount] = ctx;
+        listenerCount++;
+    }
+}
+
+void Host::raiseInterrupt(Isr isr) {
+    if (interruptsEnabled)
+        isr();
+    else
+        pendingIsr = isr;
+}
+
+uint32_t millis() {
+    Host::advance(callCost);
+    return virtualTime / 1000;
+}
+
+uint32_t micros() {
+    Host::advance(callCost);
+    return (uint32_t)virtualTime;
+}
+
+void delay(uint32_t ms) {
+    Host::advance(ms * 1000UL);
+}
+
+void delayMicroseconds(uint32_t us) {
+    Host::advance(us);
+}
+
+void noInterrupts() {
+    interruptsEnabled = false;
+}
+
+void interrupts() {
+    interruptsEnabled = true;
+    if (pendingIsr) {
+        Host::Isr isr = pendingIsr;
+        pendingIsr = nullptr;
+        isr();
+    }
+}
+
+/* Same sequence on every host, unlike rand() */
+void randomSeed(unsigned long seed) {
+    randomState = seed;
+}
+
+long random(long howBig) {
+    if (howBig <= 0)
+        return 0;
+    randomState = randomState * 1103515245UL + 12345UL;
+    return (long)((randomState >> 8) % (uint32_t)howBig);
+}
+
+long random(long howSmall, long howBig) {
+    if (howSmall >= howBig)
+        return howSmall;
+    return howSmall + random(howBig - howSmall);
+}
+
+size_t Print::write(const uint8_t *buf, size_t len) {
+    size_t n = 0;
+    while (len--)
+        n += this->write(*buf++);
+    return n;
+}
+
+size_t Print::write(const char *str) {
+    return this->write((const uint8_t *)str, strlen(str));
+}
+
+size_t Print::print(const char *str) {
+    return this->write(str);
+}
+
+size_t Print::print(char c) {
+    return this->write((uint8_t)c);
+}
+
+size_t Print::print(long value, int base) {
+    if (value < 0 && base == DEC)
+        return this->print('-') + this->print((unsigned long)-value, base);
+    return this->print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    char buf[33];
+    snprintf(buf, sizeof(buf), base == HEX ? "%lX" : "%lu", value);
+    return this->write(buf);
+}
+
+size_t Print::print(double value, int digits) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", digits, value);
+    return this->write(buf);
+}
+
+size_t Print::println() {
+    return this->write("\r\n");
+}
+
+size_t Stream::readBytes(uint8_t *buf, size_t len) {
+    size_t n = 0;
+    while (n < len) {
+        int c = this->read();
+        if (c < 0)
+            break;
+        buf[n++] = c;
+    }
+    return n;
+}
+
+size_t HardwareSerial::write(uint8_t b) {
+    if (!this->muted)
+        fputc(b, stdout);
+    return 1;
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+/*!
+ * @file Arduino.h
+ *
+ * Host implementation of Arduino core used to build the library on a
+ * workstation. Time is virtual: it moves only when code waits, calls
+ * millis()/micros() or makes bus transactions, so runs are deterministic
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define LOW             0
+#define HIGH            1
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+#define FALLING         2
+#define DEC             10
+#define HEX             16
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void noInterrupts();
+void interrupts();
+void randomSeed(unsigned long seed);
+long random(long howBig);
+long random(long howSmall, long howBig);
+
+/* Control of virtual time and interrupts of host build */
+namespace Host {
+    typedef void (*TimeListener)(void *ctx, uint64_t now);
+    typedef void (*Isr)();
+
+    /* Restores initial state: time 0, interrupts on, no listeners */
+    void reset();
+    /* Virtual time, us */
+    uint64_t now();
+    void advance(uint32_t us);
+    /* Virtual time spent by every millis()/micros() call, us */
+    void setCallCost(uint32_t us);
+    /* Called on every change of time, e.g. by device simulators */
+    void addTimeListener(TimeListener listener, void *ctx);
+    /* Calls ISR now, or when interrupts are enabled again */
+    void raiseInterrupt(Isr isr);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Base of character and binary outputs
+ */
+/******************************************************************************/
+class Print {
+    public:
+        virtual ~Print() {}
+        virtual size_t write(uint8_t b) = 0;
+        virtual size_t write(const uint8_t *buf, size_t len);
+        virtual int availableForWrite() { return 0; }
+        size_t write(const char *str);
+        size_t print(const char *str);
+        size_t print(char c);
+        size_t print(long value, int base = DEC);
+        size_t print(unsigned long value, int base = DEC);
+        size_t print(int value, int base = DEC) { return print((long)value, base); }
+        size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+        size_t print(double value, int digits = 2);
+        size_t println();
+        template<typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+        template<typename T> size_t println(T value, int arg) { size_t n = print(value, arg); return n + println(); }
+};
+
+/******************************************************************************/
+/*!
+    @brief    Base of character and binary inputs
+ */
+/******************************************************************************/
+class Stream : public Print {
+    public:
+        virtual int available() = 0;
+        virtual int read() = 0;
+        virtual int peek() = 0;
+        size_t readBytes(uint8_t *buf, size_t len);
+};
+
+/******************************************************************************/
+/*!
+    @brief    Serial port printing to stdout, input is always empty
+ */
+/******************************************************************************/
+class HardwareSerial : public Stream {
+    public:
+        void begin(unsigned long) {}
+        size_t write(uint8_t b) override;
+        using Print::write;
+        int availableForWrite() override { return 64; }
+        int available() override { return 0; }
+        int read() override { return -1; }
+        int peek() override { return -1; }
+        operator bool() { return true; }
+        /* Output is dropped when muted, e.g. in benchmarks */
+        void mute(bool muted) { this->muted = muted; }
+
+    private:
+        bool muted = false;
+};
+
+extern HardwareSerial Serial;
+
+#endif /* HOST_ARDUINO_H */
\ No newline at end of file
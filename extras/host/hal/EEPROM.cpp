@@ -0,0 +1,13 @@
+/*!
+ * @file EEPROM.cpp
+ *
+ * Host implementation of AVR EEPROM library, kept in RAM
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "EEPROM.h"
+
+EEPROMClass EEPROM;
\ No newline at end of file
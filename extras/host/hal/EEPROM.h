@@ -0,0 +1,34 @@
+/*!
+ * @file EEPROM.h
+ *
+ * Host implementation of AVR EEPROM library, kept in RAM
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include "Arduino.h"
+
+#define HOST_EEPROM_SIZE    1024
+
+class EEPROMClass {
+    public:
+        EEPROMClass() { this->erase(); }
+        uint8_t read(int addr) { return this->data[addr]; }
+        void write(int addr, uint8_t value) { this->data[addr] = value; }
+        void update(int addr, uint8_t value) { this->data[addr] = value; }
+        uint16_t length() { return HOST_EEPROM_SIZE; }
+        /* Host build only */
+        void erase() { memset(this->data, 0xFF, sizeof(this->data)); }
+
+    private:
+        uint8_t data[HOST_EEPROM_SIZE];
+};
+
+extern EEPROMClass EEPROM;
+
+#endif /* EEPROM_h */
\ No newline at end of file
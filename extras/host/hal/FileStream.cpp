@@ -0,0 +1,57 @@
+/*!
+ * @file FileStream.cpp
+ *
+ * Host file as Arduino Stream, stands in for a file on SD card
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "FileStream.h"
+
+bool Host_FileStream::open(const char *path, const char *mode) {
+    char binary[8];
+    snprintf(binary, sizeof(binary), "%sb", mode);
+    this->close();
+    this->file = fopen(path, binary);
+    return this->file != nullptr;
+}
+
+void Host_FileStream::close() {
+    if (this->file)
+        fclose(this->file);
+    this->file = nullptr;
+}
+
+size_t Host_FileStream::write(uint8_t b) {
+    return this->file ? fwrite(&b, 1, 1, this->file) : 0;
+}
+
+size_t Host_FileStream::write(const uint8_t *buf, size_t len) {
+    return this->file ? fwrite(buf, 1, len, this->file) : 0;
+}
+
+/* Bytes left up to the end of file */
+int Host_FileStream::available() {
+    if (!this->file)
+        return 0;
+    long pos = ftell(this->file);
+    fseek(this->file, 0, SEEK_END);
+    long end = ftell(this->file);
+    fseek(this->file, pos, SEEK_SET);
+    return (end > pos) ? (int)(end - pos) : 0;
+}
+
+int Host_FileStream::read() {
+    return this->file ? fgetc(this->file) : -1;
+}
+
+int Host_FileStream::peek() {
+    if (!this->file)
+        return -1;
+    int c = fgetc(this->file);
+    if (c != EOF)
+        ungetc(c, this->file);
+    return c;
+}
@@ -0,0 +1,42 @@
+/*!
+ * @file FileStream.h
+ *
+ * Host file as Arduino Stream, stands in for a file on SD card
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef HOST_FILE_STREAM_H
+#define HOST_FILE_STREAM_H
+
+#include <stdio.h>
+#include "Arduino.h"
+
+/******************************************************************************/
+/*!
+    @brief    Binary file read and written through Print and Stream
+ */
+/******************************************************************************/
+class Host_FileStream : public Stream {
+    public:
+        ~Host_FileStream() { this->close(); }
+        /* Mode as of fopen(), binary flag is added */
+        bool open(const char *path, const char *mode);
+        void close();
+        bool isOpen() { return this->file != nullptr; }
+
+        size_t write(uint8_t b) override;
+        size_t write(const uint8_t *buf, size_t len) override;
+        using Print::write;
+        int availableForWrite() override { return this->file ? 512 : 0; }
+        int available() override;
+        int read() override;
+        int peek() override;
+
+    private:
+        FILE *file = nullptr;
+};
+
+#endif /* HOST_FILE_STREAM_H */
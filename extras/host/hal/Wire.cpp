@@ -0,0 +1,96 @@
+/*!
+ * @file Wire.cpp
+ *
+ * Host implementation of Arduino TwoWire over simulated devices
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Wire.h"
+
+TwoWire Wire;
+
+void TwoWire::beginTransmission(uint8_t addr) {
+    this->txAddr = addr;
+    this->txLen = 0;
+}
+
+size_t TwoWire::write(uint8_t b) {
+    if (this->txLen >= WIRE_BUFFER_SIZE)
+        return 0;
+    this->txBuf[this->txLen++] = b;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t len) {
+    size_t n = 0;
+    while (n < len && this->write(data[n]))
+        n++;
+    return n;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    this->account(this->txLen, false);
+    if (this->failCount) {
+        this->failCount--;
+        return this->failCode;
+    }
+    Host_I2CDevice *device = this->find(this->txAddr);
+    if (!device)
+        return 2;
+    return device->onWrite(this->txBuf, this->txLen) ? 0 : 3;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t addr, uint8_t len, uint8_t sendStop) {
+    (void)sendStop;
+    if (len > WIRE_BUFFER_SIZE)
+        len = WIRE_BUFFER_SIZE;
+    this->rxPos = 0;
+    this->rxLen = 0;
+    Host_I2CDevice *device = this->find(addr);
+    if (device) {
+        this->rxLen = device->onRead(this->rxBuf, len);
+        if (this->shortCount) {
+            this->shortCount--;
+            this->rxLen /= 2;
+        }
+    }
+    this->account(this->rxLen, true);
+    return this->rxLen;
+}
+
+void TwoWire::attach(uint8_t addr, Host_I2CDevice *device) {
+    if (this->deviceCount < WIRE_MAX_DEVICES) {
+        this->addrs[this->deviceCount] = addr;
+        this->devices[this->deviceCount] = device;
+        this->deviceCount++;
+    }
+}
+
+void TwoWire::detachAll() {
+    this->deviceCount = 0;
+}
+
+Host_I2CDevice *TwoWire::find(uint8_t addr) {
+    for (uint8_t i = 0; i < this->deviceCount; i++)
+        if (this->addrs[i] == addr)
+            return this->devices[i];
+    return nullptr;
+}
+
+/* Start, address, data bytes with ACK bits and stop take bus time */
+void TwoWire::account(uint8_t bytes, bool isRead) {
+    uint32_t bits = 2 + 9 * (1 + bytes);
+    uint32_t us = (bits * 1000000UL + this->clock - 1) / this->clock;
+    this->stats.transactions++;
+    if (isRead)
+        this->stats.reads++;
+    else
+        this->stats.writes++;
+    this->stats.bytes += 1 + bytes;
+    this->stats.busTime += us;
+    Host::advance(us);
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+/*!
+ * @file Wire.h
+ *
+ * Host implementation of Arduino TwoWire. Transactions are routed to
+ * simulated devices, counted, and take virtual time of a real bus
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include "Arduino.h"
+
+#define WIRE_BUFFER_SIZE    32
+#define WIRE_MAX_DEVICES    8
+
+/******************************************************************************/
+/*!
+    @brief    Device attached to simulated bus
+ */
+/******************************************************************************/
+class Host_I2CDevice {
+    public:
+        virtual ~Host_I2CDevice() {}
+        /* Write transaction, returns false to NACK */
+        virtual bool onWrite(const uint8_t *data, uint8_t len) = 0;
+        /* Read transaction, returns number of bytes sent */
+        virtual uint8_t onRead(uint8_t *data, uint8_t len) = 0;
+};
+
+/******************************************************************************/
+/*!
+    @brief    Counters of simulated bus
+ */
+/******************************************************************************/
+struct Host_WireStats_t {
+    uint32_t transactions;
+    uint32_t writes;
+    uint32_t reads;
+    uint32_t bytes;         /* Address and data bytes on bus */
+    uint64_t busTime;       /* Virtual time of transactions, us */
+};
+
+/* As AVR core, which has setWireTimeout() and returns 5 on timeout */
+#define WIRE_HAS_TIMEOUT
+
+class TwoWire : public Stream {
+    public:
+        void begin() {}
+        void setClock(uint32_t clock) { this->clock = clock; }
+        void setWireTimeout(uint32_t timeout = 25000, bool reset = false) { this->timeout = timeout; this->timeoutReset = reset; }
+        void beginTransmission(uint8_t addr);
+        size_t write(uint8_t b) override;
+        size_t write(const uint8_t *data, size_t len) override;
+        uint8_t endTransmission(bool sendStop = true);
+        uint8_t requestFrom(uint8_t addr, uint8_t len, uint8_t sendStop = 1);
+        uint8_t requestFrom(int addr, int len) { return requestFrom((uint8_t)addr, (uint8_t)len); }
+        int available() override { return this->rxLen - this->rxPos; }
+        int read() override { return (this->rxPos < this->rxLen) ? this->rxBuf[this->rxPos++] : -1; }
+        int peek() override { return (this->rxPos < this->rxLen) ? this->rxBuf[this->rxPos] : -1; }
+
+        /* Host build only */
+        void attach(uint8_t addr, Host_I2CDevice *device);
+        void detachAll();
+        void getStats(Host_WireStats_t &stats) { stats = this->stats; }
+        void resetStats() { memset(&this->stats, 0, sizeof(this->stats)); }
+        uint32_t getWireTimeout() { return this->timeout; }
+        bool getWireTimeoutReset() { return this->timeoutReset; }
+        /* Next writes fail with given endTransmission() code, 5 is timeout */
+        void failWrites(uint8_t count, uint8_t code = 2) { this->failCount = count; this->failCode = code; }
+        /* Next reads return only half of requested bytes */
+        void shortReads(uint8_t count) { this->shortCount = count; }
+
+    private:
+        Host_I2CDevice *find(uint8_t addr);
+        void account(uint8_t bytes, bool isRead);
+
+        uint32_t clock = 100000;
+        uint32_t timeout = 0;
+        bool timeoutReset = false;
+        uint8_t txAddr = 0;
+        uint8_t txBuf[WIRE_BUFFER_SIZE];
+        uint8_t txLen = 0;
+        uint8_t rxBuf[WIRE_BUFFER_SIZE];
+        uint8_t rxLen = 0;
+        uint8_t rxPos = 0;
+        uint8_t addrs[WIRE_MAX_DEVICES];
+        Host_I2CDevice *devices[WIRE_MAX_DEVICES];
+        uint8_t deviceCount = 0;
+        uint8_t failCount = 0;
+        uint8_t failCode = 2;
+        uint8_t shortCount = 0;
+        Host_WireStats_t stats = {};
+};
+
+extern TwoWire Wire;
+
+#endif /* HOST_WIRE_H */
\ No newline at end of file
@@ -0,0 +1,82 @@
+/*!
+ * @file TCA9548A_Sim.cpp
+ *
+ * Simulator of TCA9548A I2C multiplexer for host build
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "TCA9548A_Sim.h"
+
+void TCA9548A_Sim::attach(TwoWire &wire, uint8_t addr) {
+    this->wire = &wire;
+    wire.attach(addr, this);
+}
+
+void TCA9548A_Sim::connect(uint8_t channel, uint8_t addr, Host_I2CDevice *device) {
+    if (!this->wire || channel >= SIM_MUX_CHANNELS || this->deviceCount >= SIM_MUX_DEVICES)
+        return;
+    this->channels[this->deviceCount] = channel;
+    this->addrs[this->deviceCount] = addr;
+    this->devices[this->deviceCount] = device;
+    this->deviceCount++;
+
+    /* One port on parent bus serves the address on all channels */
+    for (uint8_t i = 0; i < this->portCount; i++)
+        if (this->ports[i].addr == addr)
+            return;
+    if (this->portCount >= SIM_MUX_PORTS)
+        return;
+    Port &port = this->ports[this->portCount++];
+    port.mux = this;
+    port.addr = addr;
+    this->wire->attach(addr, &port);
+}
+
+/* Control register is written as a single byte */
+bool TCA9548A_Sim::onWrite(const uint8_t *data, uint8_t len) {
+    if (len == 0)
+        return true;
+    this->mask = data[len - 1];
+    this->stats.selects++;
+    return true;
+}
+
+uint8_t TCA9548A_Sim::onRead(uint8_t *data, uint8_t len) {
+    for (uint8_t i = 0; i < len; i++)
+        data[i] = this->mask;
+    return len;
+}
+
+/* Device answering at addr on enabled channels, nullptr to NACK */
+Host_I2CDevice *TCA9548A_Sim::route(uint8_t addr) {
+    Host_I2CDevice *found = nullptr;
+    uint8_t channel = 0;
+    for (uint8_t i = 0; i < this->deviceCount; i++) {
+        if (this->addrs[i] != addr || !(this->mask & (1 << this->channels[i])))
+            continue;
+        if (found) {
+            this->stats.conflicts++;
+            continue;
+        }
+        found = this->devices[i];
+        channel = this->channels[i];
+    }
+    if (found)
+        this->stats.forwarded[channel]++;
+    else
+        this->stats.unrouted++;
+    return found;
+}
+
+bool TCA9548A_Sim::Port::onWrite(const uint8_t *data, uint8_t len) {
+    Host_I2CDevice *device = this->mux->route(this->addr);
+    return device && device->onWrite(data, len);
+}
+
+uint8_t TCA9548A_Sim::Port::onRead(uint8_t *data, uint8_t len) {
+    Host_I2CDevice *device = this->mux->route(this->addr);
+    return device ? device->onRead(data, len) : 0;
+}
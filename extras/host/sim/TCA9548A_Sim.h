@@ -0,0 +1,77 @@
+/*!
+ * @file TCA9548A_Sim.h
+ *
+ * Simulator of TCA9548A I2C multiplexer for host build
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef TCA9548A_SIM_H
+#define TCA9548A_SIM_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define SIM_MUX_CHANNELS    8
+#define SIM_MUX_DEVICES     16
+#define SIM_MUX_PORTS       4
+
+/******************************************************************************/
+/*!
+    @brief    Counters of simulated multiplexer
+ */
+/******************************************************************************/
+struct TCA9548A_SimStats_t {
+    uint32_t selects;                           /* Writes of control register */
+    uint32_t forwarded[SIM_MUX_CHANNELS];       /* Transactions passed to channel */
+    uint32_t unrouted;                          /* Transactions no channel answered */
+    uint32_t conflicts;                         /* Transactions answered by several channels */
+};
+
+/******************************************************************************/
+/*!
+    @brief    Simulated TCA9548A attached to host TwoWire
+    @note     Control register is a mask of enabled channels, written and
+              read as one byte. Transaction to downstream address goes to
+              device connected to enabled channel, devices with the same
+              address on different channels are isolated by the mask
+ */
+/******************************************************************************/
+class TCA9548A_Sim : public Host_I2CDevice {
+    public:
+        void attach(TwoWire &wire, uint8_t addr = 0x70);
+        /* Device at addr behind channel, call after attach() */
+        void connect(uint8_t channel, uint8_t addr, Host_I2CDevice *device);
+        uint8_t getMask() { return this->mask; }
+        void getStats(TCA9548A_SimStats_t &stats) { stats = this->stats; }
+        void resetStats() { memset(&this->stats, 0, sizeof(this->stats)); }
+
+        bool onWrite(const uint8_t *data, uint8_t len) override;
+        uint8_t onRead(uint8_t *data, uint8_t len) override;
+
+    private:
+        /* Downstream address as seen on the parent bus */
+        class Port : public Host_I2CDevice {
+            public:
+                bool onWrite(const uint8_t *data, uint8_t len) override;
+                uint8_t onRead(uint8_t *data, uint8_t len) override;
+                TCA9548A_Sim *mux = nullptr;
+                uint8_t addr = 0;
+        };
+
+        Host_I2CDevice *route(uint8_t addr);
+
+        TwoWire *wire = nullptr;
+        uint8_t mask = 0;
+        Port ports[SIM_MUX_PORTS];
+        uint8_t portCount = 0;
+        uint8_t channels[SIM_MUX_DEVICES];
+        uint8_t addrs[SIM_MUX_DEVICES];
+        Host_I2CDevice *devices[SIM_MUX_DEVICES];
+        uint8_t deviceCount = 0;
+        TCA9548A_SimStats_t stats = {};
+};
+
+#endif /* TCA9548A_SIM_H */
@@ -0,0 +1,221 @@
+/*!
+ * @file TCS34725_Sim.cpp
+ *
+ * Register-level simulator of TCS34725 for host build
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "TCS34725_Sim.h"
+#include "defines.h"
+
+#define SIM_CYCLE_US    2400
+
+TCS34725_Sim::TCS34725_Sim() {
+    this->powerCycle();
+}
+
+void TCS34725_Sim::attach(TwoWire &wire, uint8_t addr) {
+    wire.attach(addr, this);
+    Host::addTimeListener(onTime, this);
+}
+
+void TCS34725_Sim::attach(TCA9548A_Sim &mux, uint8_t channel, uint8_t addr) {
+    mux.connect(channel, addr, this);
+    Host::addTimeListener(onTime, this);
+}
+
+void TCS34725_Sim::setScene(float clear, float red, float green, float blue) {
+    this->scene[0] = clear;
+    this->scene[1] = red;
+    this->scene[2] = green;
+    this->scene[3] = blue;
+}
+
+void TCS34725_Sim::setNoise(uint16_t amplitude, uint32_t seed) {
+    this->noise = amplitude;
+    this->seed = seed;
+}
+
+void TCS34725_Sim::powerCycle() {
+    memset(this->regs, 0, sizeof(this->regs));
+    memset(this->upper, 0, sizeof(this->upper));
+    this->regs[RN_ATIME] = 0xFF;
+    this->regs[RN_WTIME] = 0xFF;
+    this->regs[RN_ID] = RN_ID_ID;
+    this->pointer = 0;
+    this->autoIncrement = false;
+    this->outCount = 0;
+    this->pin = false;
+}
+
+bool TCS34725_Sim::isIntAsserted() {
+    return this->pin;
+}
+
+/* Every byte written must be preceded by command byte with CMD bit */
+bool TCS34725_Sim::onWrite(const uint8_t *data, uint8_t len) {
+    this->update(Host::now());
+    if (len == 0)
+        return true;
+    uint8_t cmd = data[0];
+    if (!(cmd & RN_COMMAND_CMD))
+        return false;
+    if ((cmd & RN_COMMAND_TYPE_SF) == RN_COMMAND_TYPE_SF) {
+        if ((cmd & 0x1F) == RN_COMMAND_ADDRSF_CLR_IRQ) {
+            this->regs[RN_STATUS] &= ~RN_STATUS_AINT;
+            this->updatePin();
+        }
+        return true;
+    }
+    this->pointer = cmd & 0x1F;
+    this->autoIncrement = (cmd & RN_COMMAND_TYPE_SF) == RN_COMMAND_TYPE_AUTOINC;
+    for (uint8_t i = 1; i < len; i++) {
+        this->writeReg(this->pointer, data[i]);
+        if (this->autoIncrement)
+            this->pointer = (this->pointer + 1) & 0x1F;
+    }
+    return true;
+}
+
+uint8_t TCS34725_Sim::onRead(uint8_t *data, uint8_t len) {
+    this->update(Host::now());
+    uint8_t first = this->pointer;
+    uint8_t last = this->autoIncrement ? first + len - 1 : first;
+    if (first <= RN_BDATAH && last >= RN_CDATAL)
+        this->stats.dataReads++;
+    if (first <= RN_CDATAL && last >= RN_BDATAH)
+        this->stats.burstReads++;
+    if (first <= RN_STATUS && last >= RN_STATUS)
+        this->stats.statusReads++;
+    for (uint8_t i = 0; i < len; i++) {
+        data[i] = this->readReg(this->pointer);
+        if (this->autoIncrement)
+            this->pointer = (this->pointer + 1) & 0x1F;
+    }
+    return len;
+}
+
+void TCS34725_Sim::onTime(void *ctx, uint64_t now) {
+    ((TCS34725_Sim *)ctx)->update(now);
+}
+
+void TCS34725_Sim::update(uint64_t now) {
+    while (this->isRunning() && now >= this->nextLatch) {
+        uint64_t latchTime = this->nextLatch;
+        this->latch();
+        /* Wait state follows integration, new settings apply to next cycle */
+        this->nextLatch = latchTime + this->getWaitTime() + this->getIntegrationTime();
+    }
+}
+
+void TCS34725_Sim::writeReg(uint8_t reg, uint8_t value) {
+    this->stats.registerWrites++;
+    switch (reg) {
+        case RN_ID:
+        case RN_STATUS:
+            return;
+        case RN_ENABLE: {
+            bool wasRunning = this->isRunning();
+            this->regs[RN_ENABLE] = value & 0x1B;
+            if (!this->isRunning())
+                this->regs[RN_STATUS] &= ~RN_STATUS_AVALID;
+            else if (!wasRunning)
+                this->nextLatch = Host::now() + this->getIntegrationTime();
+            this->updatePin();
+            return;
+        }
+        default:
+            if (reg < RN_CDATAL)
+                this->regs[reg] = value;
+    }
+}
+
+/* Reading lower byte of channel latches upper byte of the same cycle */
+uint8_t TCS34725_Sim::readReg(uint8_t reg) {
+    if (reg >= RN_CDATAL && reg <= RN_BDATAH) {
+        uint8_t ch = (reg - RN_CDATAL) / 2;
+        if ((reg & 1) == 0) {
+            this->upper[ch] = this->regs[reg + 1];
+            return this->regs[reg];
+        }
+        return this->upper[ch];
+    }
+    return (reg < SIM_REG_COUNT) ? this->regs[reg] : 0;
+}
+
+void TCS34725_Sim::latch() {
+    static const uint8_t gains[4] = {1, 4, 16, 60};
+    uint16_t cycles = 256 - this->regs[RN_ATIME];
+    uint32_t saturation = (cycles >= 64) ? 65535 : 1024UL * cycles;
+    uint16_t counts[4];
+    for (uint8_t ch = 0; ch < 4; ch++) {
+        float v = this->scene[ch] * gains[this->regs[RN_CONTROL] & 0x03] * cycles;
+        if (this->noise) {
+            this->seed = this->seed * 1103515245UL + 12345;
+            v += (int32_t)((this->seed >> 16) % (2 * this->noise + 1)) - this->noise;
+        }
+        if (v < 0)
+            v = 0;
+        counts[ch] = (v > saturation) ? saturation : (uint16_t)(v + 0.5f);
+        this->regs[RN_CDATAL + 2 * ch] = counts[ch] & 0xFF;
+        this->regs[RN_CDATAH + 2 * ch] = counts[ch] >> 8;
+    }
+    this->regs[RN_STATUS] |= RN_STATUS_AVALID;
+    this->stats.cycles++;
+    this->checkThresholds(counts[0]);
+}
+
+void TCS34725_Sim::checkThresholds(uint16_t clear) {
+    if (!(this->regs[RN_ENABLE] & RN_ENABLE_AIEN))
+        return;
+    uint16_t low = this->regs[RN_AILTL] | (this->regs[RN_AILTH] << 8);
+    uint16_t high = this->regs[RN_AIHTL] | (this->regs[RN_AIHTH] << 8);
+    uint8_t pers = this->regs[RN_PERS] & 0x0F;
+    bool trigger;
+    if (pers == 0) {
+        trigger = true;
+    } else {
+        if (clear < low || clear > high) {
+            if (this->outCount < 0xFF)
+                this->outCount++;
+        } else {
+            this->outCount = 0;
+        }
+        uint8_t needed = (pers <= 3) ? pers : (pers - 3) * 5;
+        trigger = this->outCount >= needed;
+    }
+    if (trigger) {
+        this->regs[RN_STATUS] |= RN_STATUS_AINT;
+        this->updatePin();
+    }
+}
+
+/* INT is active low output of AINT gated by AIEN, ISR runs on its edge */
+void TCS34725_Sim::updatePin() {
+    bool level = (this->regs[RN_STATUS] & RN_STATUS_AINT) && (this->regs[RN_ENABLE] & RN_ENABLE_AIEN);
+    bool edge = level && !this->pin;
+    this->pin = level;
+    if (edge) {
+        this->stats.interrupts++;
+        if (this->isr)
+            Host::raiseInterrupt(this->isr);
+    }
+}
+
+uint32_t TCS34725_Sim::getIntegrationTime() {
+    return SIM_CYCLE_US * (256UL - this->regs[RN_ATIME]);
+}
+
+uint32_t TCS34725_Sim::getWaitTime() {
+    if (!(this->regs[RN_ENABLE] & RN_ENABLE_WEN))
+        return 0;
+    uint32_t wait = SIM_CYCLE_US * (256UL - this->regs[RN_WTIME]);
+    return (this->regs[RN_CONFIG] & RN_CONFIG_WLONG) ? wait * 12 : wait;
+}
+
+bool TCS34725_Sim::isRunning() {
+    return (this->regs[RN_ENABLE] & (RN_ENABLE_PON | RN_ENABLE_AEN)) == (RN_ENABLE_PON | RN_ENABLE_AEN);
+}
\ No newline at end of file
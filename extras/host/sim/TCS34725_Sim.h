@@ -0,0 +1,91 @@
+/*!
+ * @file TCS34725_Sim.h
+ *
+ * Register-level simulator of TCS34725 for host build
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef TCS34725_SIM_H
+#define TCS34725_SIM_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "TCA9548A_Sim.h"
+
+#define SIM_REG_COUNT    0x20
+
+/******************************************************************************/
+/*!
+    @brief    Counters of simulated device
+ */
+/******************************************************************************/
+struct TCS34725_SimStats_t {
+    uint32_t cycles;            /* Completed integration cycles */
+    uint32_t dataReads;         /* Read transactions touching RGBC data */
+    uint32_t burstReads;        /* Read transactions of all 8 data bytes */
+    uint32_t statusReads;       /* Read transactions of STATUS */
+    uint32_t registerWrites;    /* Written registers */
+    uint32_t interrupts;        /* Falling edges of INT pin */
+};
+
+/******************************************************************************/
+/*!
+    @brief    Simulated TCS34725 attached to host TwoWire
+    @note     Modelled: command register with repeated byte, auto-increment
+              and special function protocols, ATIME, WTIME with WLONG, gain,
+              AVALID, clear channel thresholds with persistence filter, AINT
+              and INT pin, latching of upper data bytes. Not modelled: 2.4 ms
+              initialization after AEN, supply current, noise of real device
+ */
+/******************************************************************************/
+class TCS34725_Sim : public Host_I2CDevice {
+    public:
+        TCS34725_Sim();
+        void attach(TwoWire &wire, uint8_t addr = 0x29);
+        /* Device behind channel of multiplexer */
+        void attach(TCA9548A_Sim &mux, uint8_t channel, uint8_t addr = 0x29);
+        /* Light in counts per 2.4 ms cycle at 1x gain */
+        void setScene(float clear, float red, float green, float blue);
+        /* Adds uniform noise of given amplitude in counts, 0 disables */
+        void setNoise(uint16_t amplitude, uint32_t seed = 1);
+        void setIsr(Host::Isr isr) { this->isr = isr; }
+        /* Brown-out: all registers return to reset values */
+        void powerCycle();
+        uint8_t getReg(uint8_t reg) { return this->regs[reg]; }
+        bool isIntAsserted();
+        void getStats(TCS34725_SimStats_t &stats) { stats = this->stats; }
+        void resetStats() { memset(&this->stats, 0, sizeof(this->stats)); }
+
+        bool onWrite(const uint8_t *data, uint8_t len) override;
+        uint8_t onRead(uint8_t *data, uint8_t len) override;
+
+    private:
+        static void onTime(void *ctx, uint64_t now);
+        void update(uint64_t now);
+        void writeReg(uint8_t reg, uint8_t value);
+        uint8_t readReg(uint8_t reg);
+        void latch();
+        void checkThresholds(uint16_t clear);
+        void updatePin();
+        uint32_t getIntegrationTime();
+        uint32_t getWaitTime();
+        bool isRunning();
+
+        uint8_t regs[SIM_REG_COUNT];
+        uint8_t upper[4];
+        uint8_t pointer = 0;
+        bool autoIncrement = false;
+        float scene[4] = {};
+        uint16_t noise = 0;
+        uint32_t seed = 1;
+        uint64_t nextLatch = 0;
+        uint8_t outCount = 0;
+        bool pin = false;
+        Host::Isr isr = nullptr;
+        TCS34725_SimStats_t stats = {};
+};
+
+#endif /* TCS34725_SIM_H */
\ No newline at end of file
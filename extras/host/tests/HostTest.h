@@ -0,0 +1,49 @@
+/*!
+ * @file HostTest.h
+ *
+ * Minimal checks for host tests, each test is a separate executable
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <Arduino.h>
+#include <Wire.h>
+
+static int hostFailures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            hostFailures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        long long a_ = (long long)(actual), e_ = (long long)(expected); \
+        if (a_ != e_) { \
+            printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+            hostFailures++; \
+        } \
+    } while (0)
+
+#define RUN_TEST(test) \
+    do { \
+        Host::reset(); \
+        Wire.detachAll(); \
+        Wire.resetStats(); \
+        int before_ = hostFailures; \
+        test(); \
+        printf("%s %s\n", (hostFailures == before_) ? "PASS" : "FAIL", #test); \
+    } while (0)
+
+#define TEST_RESULT() (hostFailures ? 1 : 0)
+
+#endif /* HOST_TEST_H */
\ No newline at end of file
@@ -0,0 +1,124 @@
+/*!
+ * @file test_autorange.cpp
+ *
+ * Checks auto-ranging: convergence after step of light and handling of
+ * clipped samples
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include "TCS34725_Sim.h"
+#include <Geegrow_TCS34725.h>
+
+/* Reference configuration: 154 ms, 1x, clear saturates at 65535 */
+#define REF_SCALE   64
+
+static Geegrow_TCS34725 *sensor = nullptr;
+
+static void sensorIsr() {
+    sensor->onInterrupt();
+}
+
+/* Normalized clear value is the one of reference configuration */
+static bool nearReference(const RGBC_value_t &value, float scene) {
+    float expected = scene * REF_SCALE;
+    return value.clear > expected * 0.95f && value.clear < expected * 1.05f;
+}
+
+static void testStepUpAndDown() {
+    TCS34725_Sim sim;
+    sim.setScene(4, 2, 1, 1);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+    tcs.setAutoRange(true);
+    RGBC_value_t value;
+
+    /* Dark scene switches to the most sensitive gain */
+    for (uint8_t i = 0; i < 3; i++)
+        CHECK_EQ(tcs.getRawData(value), TCS34725_OK);
+    CHECK_EQ(sim.getReg(RN_CONTROL), RN_CONTROL_GAIN_60X);
+    CHECK(nearReference(value, 4));
+
+    /* Bright step clips clear at 60x: the sample is dropped, not returned
+       as a value far below the real one */
+    sim.setScene(800, 300, 250, 200);
+    uint8_t cycles = 0;
+    bool valid = false;
+    while (!valid && cycles < 10) {
+        delay(155);
+        cycles++;
+        valid = tcs.readIfReady(value);
+        if (valid)
+            CHECK(nearReference(value, 800));
+    }
+    CHECK(valid);
+    CHECK(cycles <= 3);
+    CHECK_EQ(sim.getReg(RN_CONTROL), RN_CONTROL_GAIN_1X);
+
+    /* Blocking read skips clipped sample too */
+    sim.setScene(4, 2, 1, 1);
+    for (uint8_t i = 0; i < 3; i++)
+        CHECK_EQ(tcs.getRawData(value), TCS34725_OK);
+    sim.setScene(800, 300, 250, 200);
+    CHECK_EQ(tcs.getRawData(value), TCS34725_OK);
+    CHECK(nearReference(value, 800));
+}
+
+static void testClippedNotFiltered() {
+    TCS34725_Sim sim;
+    sim.setScene(4, 2, 1, 1);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+    Geegrow_TCS34725_StaticFilter<4> filter;
+    filter.setMode(FILTER_BOX, 3);
+    tcs.setFilter(&filter);
+    tcs.setAutoRange(true);
+    RGBC_value_t value;
+    for (uint8_t i = 0; i < 5; i++)
+        tcs.getRawData(value);
+    /* Box filter averages 3 samples of the bright scene, a clipped one
+       would pull the average far down */
+    sim.setScene(800, 300, 250, 200);
+    for (uint8_t i = 0; i < 3; i++)
+        CHECK_EQ(tcs.getRawData(value), TCS34725_OK);
+    CHECK(nearReference(value, 800));
+}
+
+static void testInterruptMode() {
+    TCS34725_Sim sim;
+    sim.setScene(4, 2, 1, 1);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+    sensor = &tcs;
+    sim.setIsr(sensorIsr);
+    tcs.setAutoRange(true);
+    Geegrow_TCS34725_StaticSampleBuffer<8> buffer;
+    tcs.beginInterruptMode(buffer);
+    RGBC_value_t value;
+    uint16_t samples = 0, low = 0;
+    for (uint16_t ms = 0; ms < 3000; ms++) {
+        if (ms == 1000)
+            sim.setScene(800, 300, 250, 200);
+        tcs.processIRQ();
+        while (tcs.readSample(value)) {
+            samples++;
+            if (ms > 1000 && !nearReference(value, 800))
+                low++;
+        }
+        delay(1);
+    }
+    CHECK(samples > 10);
+    /* Sample integrated partly before the step clips at 60x too */
+    CHECK_EQ(low, 0);
+    tcs.endInterruptMode();
+}
+
+int main() {
+    RUN_TEST(testStepUpAndDown);
+    RUN_TEST(testClippedNotFiltered);
+    RUN_TEST(testInterruptMode);
+    return TEST_RESULT();
+}
@@ -0,0 +1,107 @@
+/*!
+ * @file test_burst_read.cpp
+ *
+ * Checks that every sample is read from device in one burst transaction
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include "TCS34725_Sim.h"
+#include <Geegrow_TCS34725.h>
+
+#define SAMPLES    20
+
+static Geegrow_TCS34725 *sensor = nullptr;
+
+static void sensorIsr() {
+    sensor->onInterrupt();
+}
+
+/* STATUS is read with data, register pointer write and 9-byte read */
+static void checkOneTransaction(Geegrow_TCS34725 &tcs, const TCS34725_SimStats_t &sim) {
+    CHECK_EQ(sim.statusReads, SAMPLES);
+    TCS34725_Stats_t stats;
+    tcs.getStats(stats);
+    CHECK_EQ(stats.transactions, 2 * SAMPLES);
+    CHECK_EQ(stats.bytes, 10 * SAMPLES);
+}
+
+static void testGetRawData() {
+    TCS34725_Sim sim;
+    sim.setScene(100, 40, 30, 20);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    sim.resetStats();
+    tcs.resetStats();
+    RGBC_value_t value;
+    for (uint8_t i = 0; i < SAMPLES; i++) {
+        CHECK_EQ(tcs.getRawData(value), TCS34725_OK);
+        CHECK_EQ(value.clear, 4000);
+        CHECK_EQ(value.red, 1600);
+        CHECK_EQ(value.green, 1200);
+        CHECK_EQ(value.blue, 800);
+    }
+    TCS34725_SimStats_t stats;
+    sim.getStats(stats);
+    CHECK_EQ(stats.burstReads, SAMPLES);
+    CHECK_EQ(stats.dataReads, SAMPLES);
+    checkOneTransaction(tcs, stats);
+}
+
+static void testReadIfReady() {
+    TCS34725_Sim sim;
+    sim.setScene(100, 40, 30, 20);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    sim.resetStats();
+    tcs.resetStats();
+    RGBC_value_t value;
+    uint8_t samples = 0;
+    while (samples < SAMPLES) {
+        if (tcs.readIfReady(value))
+            samples++;
+        delayMicroseconds(500);
+    }
+    TCS34725_SimStats_t stats;
+    sim.getStats(stats);
+    CHECK_EQ(stats.burstReads, SAMPLES);
+    CHECK_EQ(stats.dataReads, SAMPLES);
+    checkOneTransaction(tcs, stats);
+}
+
+static void testInterruptMode() {
+    TCS34725_Sim sim;
+    sim.setScene(100, 40, 30, 20);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    sensor = &tcs;
+    sim.setIsr(sensorIsr);
+    Geegrow_TCS34725_StaticSampleBuffer<8> buffer;
+    tcs.beginInterruptMode(buffer);
+    sim.resetStats();
+    RGBC_value_t value;
+    uint8_t samples = 0;
+    while (samples < SAMPLES) {
+        tcs.processIRQ();
+        while (tcs.readSample(value))
+            samples++;
+        delayMicroseconds(500);
+    }
+    TCS34725_SimStats_t stats;
+    sim.getStats(stats);
+    CHECK_EQ(stats.burstReads, SAMPLES);
+    CHECK_EQ(stats.dataReads, SAMPLES);
+    /* Interrupt flag replaces polling of STATUS */
+    CHECK_EQ(stats.statusReads, 0);
+    tcs.endInterruptMode();
+}
+
+int main() {
+    RUN_TEST(testGetRawData);
+    RUN_TEST(testReadIfReady);
+    RUN_TEST(testInterruptMode);
+    return TEST_RESULT();
+}
\ No newline at end of file
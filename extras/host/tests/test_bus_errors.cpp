@@ -0,0 +1,119 @@
+/*!
+ * @file test_bus_errors.cpp
+ *
+ * Checks that failed register reads never lead to writes of wrong values
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include "TCS34725_Sim.h"
+#include <Geegrow_TCS34725.h>
+
+/* Every transaction of one access fails, including retries */
+#define FAILED_ATTEMPTS    (I2C_RETRIES + 1)
+
+static void dropCache(Geegrow_TCS34725 &tcs) {
+    Wire.failWrites(FAILED_ATTEMPTS);
+    tcs.refresh();
+}
+
+static void testDisable() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    dropCache(tcs);
+    Wire.failWrites(FAILED_ATTEMPTS);
+    tcs.disable();
+    CHECK_EQ(tcs.getLastError(), TCS34725_ERR_NACK);
+    CHECK_EQ(sim.getReg(RN_ENABLE), RN_ENABLE_PON | RN_ENABLE_AEN);
+
+    /* Read of register succeeds, so power goes off */
+    tcs.disable();
+    CHECK_EQ(sim.getReg(RN_ENABLE), RN_ENABLE_AEN);
+}
+
+static void testStartConversion() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    tcs.setSamplePeriod(100000UL);
+    tcs.enableIRQ();
+    const uint8_t enabled = RN_ENABLE_PON | RN_ENABLE_AEN | RN_ENABLE_WEN | RN_ENABLE_AIEN;
+    CHECK_EQ(sim.getReg(RN_ENABLE), enabled);
+    dropCache(tcs);
+    Wire.shortReads(FAILED_ATTEMPTS);
+    tcs.startConversion();
+    CHECK_EQ(tcs.getLastError(), TCS34725_ERR_SHORT_READ);
+    CHECK_EQ(sim.getReg(RN_ENABLE), enabled);
+
+    /* Acquisition reports error instead of waiting on stopped device */
+    RGBC_value_t value;
+    dropCache(tcs);
+    tcs.disable();
+    dropCache(tcs);
+    Wire.failWrites(FAILED_ATTEMPTS);
+    CHECK_EQ(tcs.getRawData(value), TCS34725_ERR_NACK);
+}
+
+static void testIrqAndWait() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    dropCache(tcs);
+    Wire.failWrites(FAILED_ATTEMPTS);
+    tcs.enableIRQ();
+    CHECK_EQ(sim.getReg(RN_ENABLE), RN_ENABLE_PON | RN_ENABLE_AEN);
+    Wire.failWrites(FAILED_ATTEMPTS);
+    tcs.disableIRQ();
+    CHECK_EQ(sim.getReg(RN_ENABLE), RN_ENABLE_PON | RN_ENABLE_AEN);
+
+    /* Wait time is kept in sync with device */
+    uint32_t period = tcs.getSamplePeriod();
+    Wire.failWrites(FAILED_ATTEMPTS);
+    tcs.setSamplePeriod(500000UL);
+    CHECK_EQ(sim.getReg(RN_ENABLE), RN_ENABLE_PON | RN_ENABLE_AEN);
+    CHECK_EQ(tcs.getSamplePeriod(), period);
+}
+
+static void testTimeout() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    tcs.resetStats();
+    Wire.failWrites(FAILED_ATTEMPTS, 5);
+    tcs.setPersistence(RN_PERS_CONSEQ_VAL_5);
+    CHECK_EQ(tcs.getLastError(), TCS34725_ERR_TIMEOUT);
+    /* Timed out transactions are not counted as not acknowledged */
+    TCS34725_Stats_t stats;
+    tcs.getStats(stats);
+    CHECK_EQ(stats.timeouts, FAILED_ATTEMPTS);
+    CHECK_EQ(stats.nacks, 0);
+    CHECK_EQ(stats.retries, I2C_RETRIES);
+
+    Wire.failWrites(1);
+    tcs.setPersistence(RN_PERS_CONSEQ_VAL_5);
+    tcs.getStats(stats);
+    CHECK_EQ(stats.timeouts, FAILED_ATTEMPTS);
+    CHECK_EQ(stats.nacks, 1);
+}
+
+static void testWireTimeout() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725_WireBus bus(Wire, 10000);
+    Geegrow_TCS34725 tcs(bus, TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    CHECK_EQ(Wire.getWireTimeout(), 10000);
+    CHECK(Wire.getWireTimeoutReset());
+}
+
+int main() {
+    RUN_TEST(testDisable);
+    RUN_TEST(testStartConversion);
+    RUN_TEST(testIrqAndWait);
+    RUN_TEST(testTimeout);
+    RUN_TEST(testWireTimeout);
+    return TEST_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,246 @@
+/*!
+ * @file test_calibration.cpp
+ *
+ * Checks of calibration table and non-blocking recalibration
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include "TCS34725_Sim.h"
+#include <Geegrow_TCS34725.h>
+
+static const RGBC_value_t table[2] = {
+    {3000, 2500, 2000, 9000},
+    { 300,  250,  200,  900}
+};
+
+static void testConversion() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    int16_t red, green, blue;
+    /* No calibration, no colour */
+    tcs.convertRGB_255(table[0], red, green, blue);
+    CHECK_EQ(red, 0);
+
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> storage;
+    CHECK(tcs.setCalibrationStorage(storage));
+    CHECK(tcs.calibrateManual(table, 2));
+    tcs.convertRGB_255(table[0], red, green, blue);
+    CHECK_EQ(red, 255);
+    CHECK_EQ(green, 255);
+    CHECK_EQ(blue, 255);
+    tcs.convertRGB_255(table[1], red, green, blue);
+    CHECK_EQ(red, 255);
+    /* Half of red in white of the brightest row */
+    const RGBC_value_t pink = {3000, 1250, 1000, 9000};
+    tcs.convertRGB_255(pink, red, green, blue);
+    CHECK_EQ(red, 255);
+    CHECK(green >= 127 && green <= 128);
+}
+
+/* Scale interpolated in floating point, clamped once */
+static int16_t expected255(const RGBC_value_t *rows, uint16_t raw, uint16_t rowA, uint16_t rowB, uint16_t clear) {
+    double p = (double)(rows[0].clear - clear) / (rows[0].clear - rows[1].clear);
+    double t = raw * ((1 - p) * 255.0 / rowA + p * 255.0 / rowB);
+    return (t > 255) ? 255 : (int16_t)t;
+}
+
+static void testWideRows() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> storage;
+    tcs.setCalibrationStorage(storage);
+    const RGBC_value_t rows[2] = {
+        {60000, 60000, 60000, 65000},
+        {   30,    30,    30,   100}
+    };
+    tcs.calibrateManual(rows, 2);
+    int16_t red, green, blue;
+    /* Scale of the dim row saturates its product, interpolated one doesn't */
+    const RGBC_value_t bright = {35310, 50152, 10521, 64909};
+    tcs.convertRGB_255(bright, red, green, blue);
+    CHECK_EQ(red, 255);
+    CHECK_EQ(green, 255);
+    CHECK(abs(blue - expected255(rows, 10521, 60000, 30, 64909)) <= 1);
+
+    const RGBC_value_t samples[] = {
+        {  200,   150,   100, 64990},
+        {  900,    40,     5, 64000},
+        {   20,    35,    12,   400},
+        { 5000,  4000,  3000, 30000},
+        {   60,    70,    80,   101}
+    };
+    for (uint8_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        const RGBC_value_t &v = samples[i];
+        tcs.convertRGB_255(v, red, green, blue);
+        CHECK(abs(red - expected255(rows, v.red, 60000, 30, v.clear)) <= 1);
+        CHECK(abs(green - expected255(rows, v.green, 60000, 30, v.clear)) <= 1);
+        CHECK(abs(blue - expected255(rows, v.blue, 60000, 30, v.clear)) <= 1);
+    }
+}
+
+static void testRecalibration() {
+    TCS34725_Sim sim;
+    sim.setScene(50, 10, 10, 10);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> storage;
+    tcs.setCalibrationStorage(storage);
+    tcs.calibrateManual(table, 2);
+
+    RGBC_value_t staging[4];
+    tcs.beginCalibration(staging, 4, 0);
+    RGBC_value_t value;
+    int16_t red, green, blue;
+    for (uint8_t i = 0; i < 3; i++) {
+        CHECK_EQ(tcs.getRawData(value), TCS34725_OK);
+        /* Previous table keeps working while samples are recorded */
+        tcs.convertRGB_255(table[0], red, green, blue);
+        CHECK_EQ(red, 255);
+        uint8_t size;
+        tcs.getCalibrationValues(size);
+        CHECK_EQ(size, 2);
+    }
+    CHECK(tcs.isCalibrating());
+    CHECK_EQ(tcs.getRawData(value), TCS34725_OK);
+    CHECK(!tcs.isCalibrating());
+
+    /* Table is replaced at once by recorded samples */
+    uint8_t size;
+    const RGBC_value_t *values = tcs.getCalibrationValues(size);
+    CHECK_EQ(size, 4);
+    CHECK_EQ(values[0].clear, 2000);
+    tcs.convertRGB_255(value, red, green, blue);
+    CHECK_EQ(red, 255);
+}
+
+static void testCancel() {
+    TCS34725_Sim sim;
+    sim.setScene(50, 10, 10, 10);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> storage;
+    tcs.setCalibrationStorage(storage);
+    tcs.calibrateManual(table, 2);
+    RGBC_value_t staging[4];
+    tcs.beginCalibration(staging, 4, 0);
+    RGBC_value_t value;
+    tcs.getRawData(value);
+    tcs.cancelCalibration();
+    tcs.getRawData(value);
+    uint8_t size;
+    const RGBC_value_t *values = tcs.getCalibrationValues(size);
+    CHECK_EQ(size, 2);
+    CHECK_EQ(values[0].clear, 9000);
+}
+
+static void testBlockingCalibration() {
+    TCS34725_Sim sim;
+    sim.setScene(50, 10, 12, 14);
+    sim.attach(Wire);
+    Serial.mute(true);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> storage;
+    tcs.setCalibrationStorage(storage);
+    tcs.calibrateManual(table, 2);
+    /* Samples are recorded into the table itself */
+    tcs.calibrate();
+    uint8_t size;
+    const RGBC_value_t *values = tcs.getCalibrationValues(size);
+    CHECK_EQ(size, CALIB_TABLE_SIZE);
+    for (uint8_t i = 0; i < size; i++) {
+        CHECK_EQ(values[i].clear, 50 * 64);
+        CHECK_EQ(values[i].blue, 14 * 64);
+    }
+    int16_t red, green, blue;
+    tcs.convertRGB_255(values[0], red, green, blue);
+    CHECK_EQ(red, 255);
+    CHECK_EQ(blue, 255);
+}
+
+static void testCallerStorage() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+    Geegrow_TCS34725_CalibStorage<MIN_CALIB_TABLE_SIZE> small;
+    tcs.setCalibrationStorage(small);
+    tcs.calibrateManual(table, 2);
+    static Geegrow_TCS34725_CalibStorage<40> storage;
+    CHECK(tcs.setCalibrationStorage(storage));
+    CHECK_EQ(tcs.getCalibrationCapacity(), 40);
+
+    /* Current table moves to larger storage */
+    uint8_t size;
+    const RGBC_value_t *values = tcs.getCalibrationValues(size);
+    CHECK(values == storage.values);
+    CHECK_EQ(size, 2);
+    CHECK_EQ(values[1].clear, 900);
+
+    /* Table grows beyond default size, rows are kept sorted */
+    RGBC_value_t rows[40];
+    for (uint8_t i = 0; i < 40; i++) {
+        uint16_t clear = 1000 + ((i * 7) % 40) * 1000;
+        rows[i] = {(uint16_t)(clear / 3), (uint16_t)(clear / 4), (uint16_t)(clear / 5), clear};
+    }
+    tcs.calibrateManual(rows, 40);
+    values = tcs.getCalibrationValues(size);
+    CHECK_EQ(size, 40);
+    for (uint8_t i = 1; i < size; i++)
+        CHECK(values[i - 1].clear > values[i].clear);
+    int16_t red, green, blue;
+    const RGBC_value_t sample = {5000, 3750, 3000, 15000};
+    tcs.convertRGB_255(sample, red, green, blue);
+    CHECK_EQ(red, 255);
+    CHECK_EQ(green, 255);
+    CHECK_EQ(blue, 255);
+
+    /* Full table replaces the closest row */
+    tcs.addCalibrationSample({3400, 2550, 2040, 10200});
+    values = tcs.getCalibrationValues(size);
+    CHECK_EQ(size, 40);
+    CHECK_EQ(values[30].clear, 10200);
+
+    /* Too small storage is refused */
+    RGBC_value_t one[1];
+    CalibScale_t oneScale[1];
+    CHECK(!tcs.setCalibrationStorage(one, oneScale, 1));
+    CHECK_EQ(tcs.getCalibrationCapacity(), 40);
+}
+
+/* Driver owns no table, calibration fails until storage is given */
+static void testNoStorage() {
+    TCS34725_Sim sim;
+    sim.setScene(50, 10, 12, 14);
+    sim.attach(Wire);
+    Serial.mute(true);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    CHECK_EQ(tcs.getCalibrationCapacity(), 0);
+    CHECK(!tcs.calibrateManual(table, 2));
+    CHECK(!tcs.addCalibrationSample(table[0]));
+    RGBC_value_t staging[4];
+    CHECK(!tcs.beginCalibration(staging, 4, 0));
+    CHECK(!tcs.isCalibrating());
+    CHECK(!tcs.calibrate());
+    uint8_t size;
+    CHECK(tcs.getCalibrationValues(size) == nullptr);
+    CHECK_EQ(size, 0);
+    int16_t red, green, blue;
+    tcs.convertRGB_255(table[0], red, green, blue);
+    CHECK_EQ(red, 0);
+}
+
+int main() {
+    RUN_TEST(testConversion);
+    RUN_TEST(testWideRows);
+    RUN_TEST(testRecalibration);
+    RUN_TEST(testCancel);
+    RUN_TEST(testBlockingCalibration);
+    RUN_TEST(testCallerStorage);
+    RUN_TEST(testNoStorage);
+    return TEST_RESULT();
+}
\ No newline at end of file
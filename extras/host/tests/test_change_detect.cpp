@@ -0,0 +1,208 @@
+/*!
+ * @file test_change_detect.cpp
+ *
+ * Checks of interrupt-driven change detection against simulated thresholds
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include "TCS34725_Sim.h"
+#include <Geegrow_TCS34725.h>
+
+/* Scene of 100 counts gives clear of 4000 at 24 ms and 4x gain */
+#define BAND       400
+#define POLL_US    250
+
+static Geegrow_TCS34725 *sensor = nullptr;
+
+static void sensorIsr() {
+    sensor->onInterrupt();
+}
+
+static uint16_t getLow(TCS34725_Sim &sim) {
+    return sim.getReg(RN_AILTL) | (sim.getReg(RN_AILTH) << 8);
+}
+
+static uint16_t getHigh(TCS34725_Sim &sim) {
+    return sim.getReg(RN_AIHTL) | (sim.getReg(RN_AIHTH) << 8);
+}
+
+/* Main loop polling every POLL_US until a sample comes, false on timeout */
+static bool waitSample(Geegrow_TCS34725 &tcs, RGBC_value_t &value, uint32_t timeout) {
+    uint32_t start = micros();
+    while ((uint32_t)(micros() - start) < timeout) {
+        tcs.processIRQ();
+        if (tcs.readSample(value))
+            return true;
+        delayMicroseconds(POLL_US);
+    }
+    return false;
+}
+
+static void setup(TCS34725_Sim &sim, Geegrow_TCS34725 &tcs) {
+    sensor = &tcs;
+    sim.setIsr(sensorIsr);
+}
+
+/* Limits move around every delivered sample */
+static void testRecentre() {
+    TCS34725_Sim sim;
+    sim.setScene(100, 40, 30, 20);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    setup(sim, tcs);
+    Geegrow_TCS34725_StaticSampleBuffer<4> buffer;
+    tcs.enableChangeDetection(buffer, BAND);
+    CHECK(sim.getReg(RN_ENABLE) & RN_ENABLE_AIEN);
+
+    const float scenes[] = {100, 150, 60, 61, 200, 100};
+    RGBC_value_t value;
+    for (uint8_t i = 0; i < sizeof(scenes) / sizeof(scenes[0]); i++) {
+        sim.setScene(scenes[i], 40, 30, 20);
+        uint16_t clear = scenes[i] * 40;
+        uint16_t previous = getLow(sim) + BAND;
+        /* Step within band is not delivered, limits stay */
+        if (i > 0 && abs(clear - previous) <= BAND) {
+            CHECK(!waitSample(tcs, value, 100000));
+            CHECK_EQ(getLow(sim), previous - BAND);
+            continue;
+        }
+        CHECK(waitSample(tcs, value, 100000));
+        CHECK_EQ(value.clear, clear);
+        CHECK_EQ(getLow(sim), clear - BAND);
+        CHECK_EQ(getHigh(sim), clear + BAND);
+    }
+    tcs.disableChangeDetection();
+}
+
+/* Persistence 0 would give IRQ on every cycle, it is raised to 1 */
+static void testPersistenceZero() {
+    TCS34725_Sim sim;
+    sim.setScene(100, 40, 30, 20);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    setup(sim, tcs);
+    Geegrow_TCS34725_StaticSampleBuffer<4> buffer;
+    tcs.enableChangeDetection(buffer, BAND, RN_PERS_CONSEQ_VAL_0);
+    CHECK_EQ(sim.getReg(RN_PERS) & 0x0F, RN_PERS_CONSEQ_VAL_1);
+
+    RGBC_value_t value;
+    CHECK(waitSample(tcs, value, 100000));
+    CHECK(!waitSample(tcs, value, 200000));
+    tcs.disableChangeDetection();
+}
+
+/* Constant scene costs no bus traffic and gives no samples */
+static void testQuietScene() {
+    TCS34725_Sim sim;
+    sim.setScene(100, 40, 30, 20);
+    sim.setNoise(BAND / 2);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    setup(sim, tcs);
+    Geegrow_TCS34725_StaticSampleBuffer<4> buffer;
+    tcs.enableChangeDetection(buffer, BAND);
+    RGBC_value_t value;
+    CHECK(waitSample(tcs, value, 100000));
+
+    sim.resetStats();
+    tcs.resetStats();
+    /* About 40 integration cycles */
+    CHECK(!waitSample(tcs, value, 1000000));
+    TCS34725_SimStats_t simStats;
+    sim.getStats(simStats);
+    CHECK(simStats.cycles >= 40);
+    CHECK_EQ(simStats.interrupts, 0);
+    TCS34725_Stats_t stats;
+    tcs.getStats(stats);
+    CHECK_EQ(stats.transactions, 0);
+    CHECK_EQ(tcs.samplesAvailable(), 0);
+    uint16_t overflow, missed;
+    tcs.getDroppedSamples(overflow, missed);
+    CHECK_EQ(overflow, 0);
+    CHECK_EQ(missed, 0);
+    tcs.disableChangeDetection();
+}
+
+/* Step change is delivered by the next latch, at any phase of cycle */
+static void testStepLatency() {
+    TCS34725_Sim sim;
+    sim.setScene(100, 40, 30, 20);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    setup(sim, tcs);
+    Geegrow_TCS34725_StaticSampleBuffer<4> buffer;
+    tcs.enableChangeDetection(buffer, BAND);
+    RGBC_value_t value;
+    CHECK(waitSample(tcs, value, 100000));
+
+    uint32_t cycle = tcs.getIntegrationTime_us();
+    for (uint8_t i = 0; i < 8; i++) {
+        /* Step at different points of integration cycle */
+        delayMicroseconds(3100 * i + 700);
+        sim.setScene((i % 2) ? 100 : 200, 40, 30, 20);
+        tcs.resetStats();
+        uint32_t start = micros();
+        CHECK(waitSample(tcs, value, 3 * cycle));
+        /* Latch, poll of main loop and the read itself */
+        TCS34725_Stats_t stats;
+        tcs.getStats(stats);
+        CHECK((uint32_t)(micros() - start) <= cycle + POLL_US + stats.busTime);
+        CHECK_EQ(value.clear, ((i % 2) ? 100 : 200) * 40);
+        CHECK(!tcs.readSample(value));
+    }
+    tcs.disableChangeDetection();
+}
+
+/* Interrupt setup made before change detection comes back after it */
+static void testRestore() {
+    TCS34725_Sim sim;
+    sim.setScene(100, 40, 30, 20);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    setup(sim, tcs);
+    Geegrow_TCS34725_StaticSampleBuffer<4> buffer;
+    RGBC_value_t value;
+
+    /* Interrupts disabled, limits and persistence set by user */
+    tcs.setLimitsIRQ(3000, 1000);
+    tcs.setPersistence(RN_PERS_CONSEQ_VAL_5);
+    tcs.enableChangeDetection(buffer, BAND);
+    CHECK(waitSample(tcs, value, 100000));
+    tcs.disableChangeDetection();
+    CHECK_EQ(getLow(sim), 1000);
+    CHECK_EQ(getHigh(sim), 3000);
+    CHECK_EQ(sim.getReg(RN_PERS) & 0x0F, RN_PERS_CONSEQ_VAL_5);
+    CHECK(!(sim.getReg(RN_ENABLE) & RN_ENABLE_AIEN));
+    CHECK(!sim.isIntAsserted());
+
+    /* Interrupt mode of every cycle goes on with its own buffer */
+    Geegrow_TCS34725_StaticSampleBuffer<4> cycles;
+    tcs.setLimitsIRQ(0, 0);
+    tcs.beginInterruptMode(cycles);
+    CHECK(waitSample(tcs, value, 100000));
+    tcs.enableChangeDetection(buffer, BAND);
+    CHECK(waitSample(tcs, value, 100000));
+    CHECK(!waitSample(tcs, value, 200000));
+    tcs.disableChangeDetection();
+    CHECK_EQ(getLow(sim), 0);
+    CHECK_EQ(getHigh(sim), 0);
+    CHECK_EQ(sim.getReg(RN_PERS) & 0x0F, RN_PERS_CONSEQ_VAL_0);
+    CHECK(sim.getReg(RN_ENABLE) & RN_ENABLE_AIEN);
+    for (uint8_t i = 0; i < 4; i++)
+        CHECK(waitSample(tcs, value, 2 * tcs.getIntegrationTime_us()));
+    CHECK_EQ(buffer.available(), 0);
+    tcs.endInterruptMode();
+}
+
+int main() {
+    RUN_TEST(testRecentre);
+    RUN_TEST(testPersistenceZero);
+    RUN_TEST(testQuietScene);
+    RUN_TEST(testStepLatency);
+    RUN_TEST(testRestore);
+    return TEST_RESULT();
+}
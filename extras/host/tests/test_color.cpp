@@ -0,0 +1,158 @@
+/*!
+ * @file test_color.cpp
+ *
+ * Checks of colour-science conversions
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include <Geegrow_TCS34725_Color.h>
+#include <math.h>
+
+static void testWhite() {
+    Geegrow_TCS34725_Color color;
+    Color_XYZ_t white = {47524, 50000, 54442};
+    Color_Lab_t lab;
+    color.toLab(white, lab);
+    CHECK(lab.L >= 9990 && lab.L <= 10010);
+    CHECK(lab.a >= -10 && lab.a <= 10);
+    CHECK(lab.b >= -10 && lab.b <= 10);
+}
+
+static void testSaturation() {
+    Geegrow_TCS34725_Color color;
+    Color_XYZ_t white = {10000, 10000, 10000};
+    color.setWhitePoint(white);
+    Color_Lab_t lab;
+    /* a* = 500 * (f(4) - f(0)) is out of int16_t range in hundredths */
+    Color_XYZ_t red = {40000, 0, 0};
+    color.toLab(red, lab);
+    CHECK_EQ(lab.a, 32767);
+    Color_XYZ_t green = {0, 40000, 0};
+    color.toLab(green, lab);
+    CHECK_EQ(lab.a, -32768);
+    CHECK(lab.b > 0);
+    Color_XYZ_t blue = {0, 0, 40000};
+    color.toLab(blue, lab);
+    CHECK(lab.b < 0);
+}
+
+/* L* over the range of cube-root segment matches floating point */
+static void testLightness() {
+    Geegrow_TCS34725_Color color;
+    Color_XYZ_t white = {10000, 10000, 10000};
+    color.setWhitePoint(white);
+    Color_Lab_t lab;
+    int16_t maxError = 0;
+    for (uint32_t y = 90; y < 40000; y += 7) {
+        Color_XYZ_t xyz = {(uint16_t)y, (uint16_t)y, (uint16_t)y};
+        color.toLab(xyz, lab);
+        double ratio = (double)(((uint32_t)y << 16) / 10000) / 65536;
+        double ref = 100 * (116 * cbrt(ratio) - 16);
+        int16_t error = abs(lab.L - (int16_t)lround(ref));
+        if (error > maxError)
+            maxError = error;
+        CHECK_EQ(lab.a, 0);
+        CHECK_EQ(lab.b, 0);
+    }
+    /* 1 LSB of Q12 cube root is 2.8 hundredths of L* */
+    CHECK(maxError <= 4);
+}
+
+/* Reference of getLux() in floating point */
+static double luxFloat(const RGBC_value_t &v, uint16_t cycles, uint8_t gain) {
+    double ir = (v.red + v.green + v.blue - v.clear) / 2.0;
+    if (ir < 0)
+        ir = 0;
+    double g = 0.136 * (v.red - ir) + (v.green - ir) - 0.444 * (v.blue - ir);
+    return g * COLOR_LUX_DF / (2.4 * cycles * gain) * COLOR_LUX_SCALE;
+}
+
+static void testLux() {
+    Geegrow_TCS34725_Color color;
+    const uint8_t atimes[] = {RN_ATIME_INTEG_TIME_2_4, RN_ATIME_INTEG_TIME_24, RN_ATIME_INTEG_TIME_154, RN_ATIME_INTEG_TIME_700};
+    const uint8_t gains[] = {RN_CONTROL_GAIN_1X, RN_CONTROL_GAIN_4X, RN_CONTROL_GAIN_16X, RN_CONTROL_GAIN_60X};
+    const uint8_t gainValues[] = {1, 4, 16, 60};
+    const RGBC_value_t samples[] = {
+        {1000, 1000, 1000, 3000},
+        {4000, 2500, 1200, 8000},
+        {20000, 30000, 15000, 60000}
+    };
+    for (uint8_t a = 0; a < 4; a++) {
+        for (uint8_t g = 0; g < 4; g++) {
+            color.setConfig(atimes[a], gains[g]);
+            for (uint8_t i = 0; i < 3; i++) {
+                double ref = luxFloat(samples[i], TCS34725_cycles(atimes[a]), gainValues[g]);
+                uint32_t lux = color.getLux(samples[i]);
+                CHECK(fabs(lux - ref) <= ref * 0.002 + 1);
+            }
+        }
+    }
+    /* Gray at 154 ms and 1x: G' = 692, 692 * 310 / 153.6 = 1396.6 lux */
+    color.setConfig(RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+    uint32_t lux = color.getLux(samples[0]);
+    CHECK(lux >= 139600 && lux <= 139700);
+}
+
+static void testCCT() {
+    Geegrow_TCS34725_Color color;
+    /* No IR component: C = R + G + B */
+    RGBC_value_t warm = {1000, 800, 500, 2300};
+    CHECK_EQ(color.getCCT(warm), 3810UL * 500 / 1000 + 1391);
+    RGBC_value_t cold = {600, 800, 1200, 2600};
+    CHECK_EQ(color.getCCT(cold), 3810UL * 1200 / 600 + 1391);
+    /* IR = 100 is removed from both channels */
+    RGBC_value_t ir = {1100, 900, 600, 2400};
+    CHECK_EQ(color.getCCT(ir), 3810UL * 500 / 1000 + 1391);
+    RGBC_value_t blue = {0, 0, 1000, 1000};
+    CHECK_EQ(color.getCCT(blue), 0);
+}
+
+static void testHSV() {
+    Geegrow_TCS34725_Color color;
+    color.setConfig(RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+    Color_HSV_t hsv;
+    const struct {
+        RGBC_value_t value;
+        uint16_t hue;
+        uint8_t saturation;
+    } cases[] = {
+        {{20000, 0, 0, 20000}, 0, 255},
+        {{0, 20000, 0, 20000}, 120, 255},
+        {{0, 0, 20000, 20000}, 240, 255},
+        {{20000, 20000, 0, 40000}, 60, 255},
+        {{0, 20000, 20000, 40000}, 180, 255},
+        {{20000, 0, 20000, 40000}, 300, 255},
+        {{20000, 10000, 10000, 40000}, 0, 127},
+        {{20000, 20000, 20000, 60000}, 0, 0}
+    };
+    for (uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        color.toHSV(cases[i].value, hsv);
+        CHECK_EQ(hsv.hue, cases[i].hue);
+        CHECK_EQ(hsv.saturation, cases[i].saturation);
+        /* Value is the largest channel relative to saturation level */
+        CHECK_EQ(hsv.value, 20000UL * 255 / 65535);
+    }
+    /* Between red and yellow */
+    RGBC_value_t orange = {20000, 10000, 0, 30000};
+    color.toHSV(orange, hsv);
+    CHECK_EQ(hsv.hue, 30);
+    /* Brightest channel at saturation level of shorter integration time */
+    color.setConfig(RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_1X);
+    RGBC_value_t bright = {10240, 0, 0, 10240};
+    color.toHSV(bright, hsv);
+    CHECK_EQ(hsv.value, 255);
+}
+
+int main() {
+    RUN_TEST(testWhite);
+    RUN_TEST(testSaturation);
+    RUN_TEST(testLightness);
+    RUN_TEST(testLux);
+    RUN_TEST(testCCT);
+    RUN_TEST(testHSV);
+    return TEST_RESULT();
+}
\ No newline at end of file
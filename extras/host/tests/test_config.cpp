@@ -0,0 +1,52 @@
+/*!
+ * @file test_config.cpp
+ *
+ * Checks of configuration fixed at compile time
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include "TCS34725_Sim.h"
+#include <Geegrow_TCS34725.h>
+
+typedef Geegrow_TCS34725_Config<TCS34725_atimeFor_us(50000), RN_CONTROL_GAIN_16X> FastConfig;
+typedef Geegrow_TCS34725_Config<RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X> SlowConfig;
+
+static_assert(FastConfig::cycles == 20, "20 cycles fit into 50 ms");
+static_assert(FastConfig::integrationTime_us == 48000, "20 cycles take 48 ms");
+static_assert(FastConfig::saturation == 20480, "1024 counts per cycle");
+static_assert(SlowConfig::saturation == 0xFFFF, "16-bit limit");
+
+static void testConstructor() {
+    TCS34725_Sim sim;
+    sim.setScene(1000, 400, 300, 200);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(FastConfig(), TCS34725_I2C_ADDRESS);
+    CHECK_EQ(sim.getReg(RN_ATIME), FastConfig::atime);
+    CHECK_EQ(sim.getReg(RN_CONTROL), FastConfig::gain);
+    CHECK_EQ(tcs.getIntegrationTime_us(), FastConfig::integrationTime_us);
+    /* Saturation level derived at compile time matches the device */
+    RGBC_value_t value;
+    CHECK_EQ(tcs.getRawData(value), TCS34725_OK);
+    CHECK_EQ(value.clear, FastConfig::saturation);
+}
+
+static void testSetConfig() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725_WireBus bus(Wire);
+    Geegrow_TCS34725 tcs(bus, FastConfig());
+    tcs.setConfig(SlowConfig());
+    CHECK_EQ(sim.getReg(RN_ATIME), SlowConfig::atime);
+    CHECK_EQ(sim.getReg(RN_CONTROL), SlowConfig::gain);
+    CHECK_EQ(tcs.getIntegrationTime_us(), SlowConfig::integrationTime_us);
+}
+
+int main() {
+    RUN_TEST(testConstructor);
+    RUN_TEST(testSetConfig);
+    return TEST_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+/*!
+ * @file test_conversion.cpp
+ *
+ * Checks fixed-point conversion against the same conversion in floating
+ * point over random calibration tables and samples
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include "TCS34725_Sim.h"
+#include <Geegrow_TCS34725.h>
+
+#define TABLES      200
+#define SAMPLES     500
+#define TABLE_ROWS  32
+
+/* Scale of rows around the sample interpolated in floating point,
+   product clamped once, as the fixed-point path is documented to do */
+static void convertFloat(const RGBC_value_t *calib, uint8_t size, const RGBC_value_t &value, int16_t *out) {
+    if (value.clear == 0) {
+        out[0] = out[1] = out[2] = 0;
+        return;
+    }
+    uint8_t lo = 0, hi = 0;
+    double pos = 0;
+    if (value.clear <= calib[size - 1].clear) {
+        lo = hi = size - 1;
+    } else if (value.clear < calib[0].clear) {
+        while (calib[hi].clear > value.clear)
+            hi++;
+        lo = hi - 1;
+        pos = (double)(calib[lo].clear - value.clear) / (calib[lo].clear - calib[hi].clear);
+    }
+    const uint16_t raw[3] = {value.red, value.green, value.blue};
+    const uint16_t refLo[3] = {calib[lo].red, calib[lo].green, calib[lo].blue};
+    const uint16_t refHi[3] = {calib[hi].red, calib[hi].green, calib[hi].blue};
+    for (uint8_t ch = 0; ch < 3; ch++) {
+        double scale = (1 - pos) * 255.0 / refLo[ch] + pos * 255.0 / refHi[ch];
+        double t = raw[ch] * scale;
+        out[ch] = (t > 255) ? 255 : (int16_t)t;
+    }
+}
+
+static uint16_t randomChannel(uint16_t clear) {
+    /* Reference row channels are a part of clear, never zero */
+    long low = clear / 10;
+    return (uint16_t)random(low ? low : 1, (long)clear + 1);
+}
+
+static void testRandomTables() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+    static Geegrow_TCS34725_CalibStorage<TABLE_ROWS> storage;
+    tcs.setCalibrationStorage(storage);
+    randomSeed(34725);
+    int16_t maxError = 0;
+    uint32_t exact = 0, total = 0;
+    for (uint16_t n = 0; n < TABLES; n++) {
+        RGBC_value_t table[TABLE_ROWS];
+        uint8_t size = random(2, TABLE_ROWS + 1);
+        /* Distinct clear values, rows come in random order */
+        for (uint8_t i = 0; i < size; i++) {
+            uint16_t clear;
+            bool unique;
+            do {
+                clear = random(2, 65536);
+                unique = true;
+                for (uint8_t j = 0; j < i; j++)
+                    unique = unique && table[j].clear != clear;
+            } while (!unique);
+            table[i] = {randomChannel(clear), randomChannel(clear), randomChannel(clear), clear};
+        }
+        tcs.calibrateManual(table, size);
+
+        uint8_t loaded;
+        const RGBC_value_t *calib = tcs.getCalibrationValues(loaded);
+        CHECK_EQ(loaded, size);
+        for (uint16_t s = 0; s < SAMPLES; s++) {
+            RGBC_value_t value;
+            value.clear = random(0, 65536);
+            value.red   = random(0, (long)value.clear + 1);
+            value.green = random(0, (long)value.clear + 1);
+            value.blue  = random(0, (long)value.clear + 1);
+            int16_t fixed[3], ref[3];
+            tcs.convertRGB_255(value, fixed[0], fixed[1], fixed[2]);
+            convertFloat(calib, loaded, value, ref);
+            for (uint8_t ch = 0; ch < 3; ch++) {
+                int16_t error = abs(fixed[ch] - ref[ch]);
+                if (error > maxError)
+                    maxError = error;
+                if (error == 0)
+                    exact++;
+                total++;
+            }
+        }
+    }
+    printf("  max error %d LSB, exact %.2f%%\n", maxError, 100.0 * exact / total);
+    CHECK(maxError <= 1);
+}
+
+/* Samples at calibration rows and at midpoints between them */
+static void testRowsAndMidpoints() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+    Geegrow_TCS34725_CalibStorage<4> storage;
+    tcs.setCalibrationStorage(storage);
+    randomSeed(9548);
+    for (uint16_t n = 0; n < TABLES; n++) {
+        RGBC_value_t table[4];
+        for (uint8_t i = 0; i < 4; i++) {
+            uint16_t clear = 60000 - i * 15000 - random(0, 10000);
+            table[i] = {randomChannel(clear), randomChannel(clear), randomChannel(clear), clear};
+        }
+        tcs.calibrateManual(table, 4);
+        int16_t red, green, blue;
+        for (uint8_t i = 0; i < 4; i++) {
+            tcs.convertRGB_255(table[i], red, green, blue);
+            CHECK_EQ(red, 255);
+            CHECK_EQ(green, 255);
+            CHECK_EQ(blue, 255);
+        }
+        for (uint8_t i = 0; i < 3; i++) {
+            RGBC_value_t mid = {
+                (uint16_t)((table[i].red + table[i + 1].red) / 4),
+                (uint16_t)((table[i].green + table[i + 1].green) / 4),
+                (uint16_t)((table[i].blue + table[i + 1].blue) / 4),
+                (uint16_t)((table[i].clear + table[i + 1].clear) / 2)
+            };
+            int16_t ref[3];
+            convertFloat(table, 4, mid, ref);
+            tcs.convertRGB_255(mid, red, green, blue);
+            CHECK(abs(red - ref[0]) <= 1);
+            CHECK(abs(green - ref[1]) <= 1);
+            CHECK(abs(blue - ref[2]) <= 1);
+        }
+    }
+}
+
+int main() {
+    RUN_TEST(testRandomTables);
+    RUN_TEST(testRowsAndMidpoints);
+    return TEST_RESULT();
+}
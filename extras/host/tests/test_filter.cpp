@@ -0,0 +1,146 @@
+/*!
+ * @file test_filter.cpp
+ *
+ * Checks of sample filters and running statistics
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include <Geegrow_TCS34725_Filter.h>
+
+static RGBC_value_t gray(uint16_t v) {
+    RGBC_value_t value = {v, v, v, v};
+    return value;
+}
+
+static void testMean() {
+    Geegrow_TCS34725_Filter filter;
+    for (uint16_t i = 0; i < 5000; i++) {
+        RGBC_value_t value = gray(1000);
+        filter.apply(value);
+    }
+    for (uint16_t i = 0; i < 5000; i++) {
+        RGBC_value_t value = gray(1100);
+        filter.apply(value);
+    }
+    RGBC_value_t mean;
+    filter.getMean(mean);
+    CHECK_EQ(mean.clear, 1050);
+    uint32_t variance[4];
+    filter.getVariance(variance);
+    /* 50^2 * 10000 / 9999 */
+    CHECK_EQ(variance[3], 2500);
+}
+
+static void testFullScale() {
+    Geegrow_TCS34725_Filter filter;
+    for (uint8_t i = 0; i < 100; i++) {
+        RGBC_value_t value = gray((i & 1) ? 65535 : 0);
+        filter.apply(value);
+    }
+    RGBC_value_t mean;
+    filter.getMean(mean);
+    CHECK(mean.clear == 32767 || mean.clear == 32768);
+    uint32_t variance[4];
+    filter.getVariance(variance);
+    /* 32767.5^2 * 100 / 99 */
+    CHECK_EQ(variance[3], 1084554602);
+}
+
+static void testEma() {
+    const uint8_t params[] = {1, 4, 8, 12, 15};
+    for (uint8_t p = 0; p < sizeof(params); p++) {
+        Geegrow_TCS34725_Filter filter;
+        filter.setMode(FILTER_EMA, params[p]);
+        RGBC_value_t value = gray(0);
+        filter.apply(value);
+        /* Settles exactly on constant input from below and from above */
+        for (uint32_t i = 0; i < 400000UL; i++) {
+            value = gray(5000);
+            filter.apply(value);
+        }
+        CHECK_EQ(value.clear, 5000);
+        for (uint32_t i = 0; i < 400000UL; i++) {
+            value = gray(4000);
+            filter.apply(value);
+        }
+        CHECK_EQ(value.clear, 4000);
+    }
+}
+
+static void testBoxMedian() {
+    Geegrow_TCS34725_StaticFilter<4> filter;
+    filter.setMode(FILTER_BOX, 4);
+    const uint16_t input[] = {100, 200, 300, 400, 500};
+    RGBC_value_t value;
+    for (uint8_t i = 0; i < 5; i++) {
+        value = gray(input[i]);
+        filter.apply(value);
+    }
+    CHECK_EQ(value.clear, 350);
+
+    filter.setMode(FILTER_MEDIAN, 3);
+    const uint16_t spikes[] = {100, 9000, 110, 120};
+    for (uint8_t i = 0; i < 4; i++) {
+        value = gray(spikes[i]);
+        filter.apply(value);
+    }
+    CHECK_EQ(value.clear, 120);
+}
+
+/* Median of wide window against sorted copy */
+static void testWideMedian() {
+    Geegrow_TCS34725_StaticFilter<31> filter;
+    filter.setMode(FILTER_MEDIAN, 31);
+    uint16_t history[31];
+    randomSeed(13);
+    for (uint16_t n = 0; n < 500; n++) {
+        uint16_t v = random(0, 50) * 100;
+        history[n % 31] = v;
+        RGBC_value_t value = gray(v);
+        filter.apply(value);
+        uint8_t fill = (n < 31) ? n + 1 : 31;
+        uint16_t sorted[31];
+        memcpy(sorted, history, fill * sizeof(uint16_t));
+        for (uint8_t i = 1; i < fill; i++)
+            for (uint8_t k = i; k > 0 && sorted[k - 1] > sorted[k]; k--) {
+                uint16_t t = sorted[k];
+                sorted[k] = sorted[k - 1];
+                sorted[k - 1] = t;
+            }
+        CHECK_EQ(value.clear, sorted[fill / 2]);
+    }
+}
+
+/* Window is limited by storage, filter without one passes samples */
+static void testWindowSize() {
+    Geegrow_TCS34725_StaticFilter<2> small;
+    small.setMode(FILTER_BOX, 8);
+    const uint16_t input[] = {100, 200, 300, 400};
+    RGBC_value_t value;
+    for (uint8_t i = 0; i < 4; i++) {
+        value = gray(input[i]);
+        small.apply(value);
+    }
+    CHECK_EQ(value.clear, 350);
+
+    Geegrow_TCS34725_Filter none;
+    none.setMode(FILTER_MEDIAN, 3);
+    value = gray(9000);
+    none.apply(value);
+    CHECK_EQ(value.clear, 9000);
+    CHECK_EQ(none.getCount(), 1);
+}
+
+int main() {
+    RUN_TEST(testMean);
+    RUN_TEST(testFullScale);
+    RUN_TEST(testEma);
+    RUN_TEST(testBoxMedian);
+    RUN_TEST(testWideMedian);
+    RUN_TEST(testWindowSize);
+    return TEST_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+/*!
+ * @file test_mux.cpp
+ *
+ * Checks of sensors behind TCA9548A multiplexer and of sensor array
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include "TCS34725_Sim.h"
+#include "TCA9548A_Sim.h"
+#include <Geegrow_TCS34725.h>
+#include <Geegrow_TCS34725_Array.h>
+
+#define SENSORS     3
+
+static const uint8_t channels[SENSORS] = {1, 4, 6};
+
+/* Every sensor sees its own light, clear differs by decade */
+static float sceneOf(uint8_t i) {
+    return (i == 0) ? 10 : (i == 1) ? 100 : 1000;
+}
+
+static bool isScene(const RGBC_value_t &value, uint8_t i, uint8_t gainFactor) {
+    float expected = sceneOf(i) * gainFactor * 10;
+    return value.clear > expected * 0.95f && value.clear < expected * 1.05f;
+}
+
+static void setupMux(TCA9548A_Sim &mux, TCS34725_Sim *sims) {
+    mux.attach(Wire);
+    for (uint8_t i = 0; i < SENSORS; i++) {
+        sims[i].setScene(sceneOf(i), sceneOf(i) / 2, sceneOf(i) / 3, sceneOf(i) / 4);
+        sims[i].attach(mux, channels[i]);
+    }
+}
+
+static void testSelectBeforeTransaction() {
+    TCA9548A_Sim muxSim;
+    TCS34725_Sim sims[SENSORS];
+    setupMux(muxSim, sims);
+    Geegrow_TCS34725_WireBus wireBus(Wire);
+    Geegrow_TCS34725_Mux mux(wireBus);
+    Geegrow_TCS34725_MuxBus bus0(mux, channels[0]);
+    Geegrow_TCS34725_MuxBus bus1(mux, channels[1]);
+    Geegrow_TCS34725 tcs0(bus0, TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_1X);
+    Geegrow_TCS34725 tcs1(bus1, TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_1X);
+
+    /* Setup of each driver reached its own device only */
+    CHECK_EQ(sims[0].getReg(RN_ENABLE), RN_ENABLE_PON | RN_ENABLE_AEN);
+    CHECK_EQ(sims[1].getReg(RN_ENABLE), RN_ENABLE_PON | RN_ENABLE_AEN);
+    CHECK_EQ(sims[2].getReg(RN_ENABLE), 0);
+
+    muxSim.resetStats();
+    tcs0.resetStats();
+    tcs1.resetStats();
+    RGBC_value_t value;
+    for (uint8_t i = 0; i < 5; i++) {
+        CHECK_EQ(tcs0.getRawData(value), TCS34725_OK);
+        CHECK(isScene(value, 0, 1));
+        CHECK_EQ(tcs1.getRawData(value), TCS34725_OK);
+        CHECK(isScene(value, 1, 1));
+    }
+
+    /* Every transaction of a driver arrived at its channel */
+    TCA9548A_SimStats_t stats;
+    muxSim.getStats(stats);
+    TCS34725_Stats_t s0, s1;
+    tcs0.getStats(s0);
+    tcs1.getStats(s1);
+    CHECK_EQ(stats.unrouted, 0);
+    CHECK_EQ(stats.conflicts, 0);
+    CHECK_EQ(stats.forwarded[channels[0]], s0.transactions);
+    CHECK_EQ(stats.forwarded[channels[1]], s1.transactions);
+    CHECK_EQ(stats.forwarded[channels[2]], 0);
+    /* Channel is switched once per change of driver */
+    CHECK_EQ(stats.selects, 10);
+}
+
+static void testNoReselect() {
+    TCA9548A_Sim muxSim;
+    TCS34725_Sim sims[SENSORS];
+    setupMux(muxSim, sims);
+    Geegrow_TCS34725_WireBus wireBus(Wire);
+    Geegrow_TCS34725_Mux mux(wireBus);
+    Geegrow_TCS34725_MuxBus bus(mux, channels[2]);
+    Geegrow_TCS34725 tcs(bus, TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_1X);
+    TCA9548A_SimStats_t stats;
+    muxSim.getStats(stats);
+    CHECK_EQ(stats.selects, 1);
+    CHECK_EQ(muxSim.getMask(), 1 << channels[2]);
+
+    muxSim.resetStats();
+    Wire.resetStats();
+    RGBC_value_t value;
+    for (uint8_t i = 0; i < 10; i++) {
+        CHECK_EQ(tcs.getRawData(value), TCS34725_OK);
+        CHECK(isScene(value, 2, 1));
+    }
+    muxSim.getStats(stats);
+    Host_WireStats_t wire;
+    Wire.getStats(wire);
+    CHECK_EQ(stats.selects, 0);
+    CHECK_EQ(stats.forwarded[channels[2]], wire.transactions);
+}
+
+static void testSelectFailure() {
+    TCA9548A_Sim muxSim;
+    TCS34725_Sim sims[SENSORS];
+    setupMux(muxSim, sims);
+    Geegrow_TCS34725_WireBus wireBus(Wire);
+    Geegrow_TCS34725_Mux mux(wireBus);
+    Geegrow_TCS34725_MuxBus bus0(mux, channels[0]);
+    Geegrow_TCS34725_MuxBus bus1(mux, channels[1]);
+    Geegrow_TCS34725 tcs0(bus0, TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_1X);
+    Geegrow_TCS34725 tcs1(bus1, TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_1X);
+    RGBC_value_t value;
+    CHECK_EQ(tcs1.getRawData(value), TCS34725_OK);
+
+    /* Failed switch to channel of tcs0: its transaction doesn't go to tcs1 */
+    muxSim.resetStats();
+    tcs0.setRetries(0);
+    Wire.failWrites(1);
+    CHECK_EQ(tcs0.getRawData(value), TCS34725_ERR_NACK);
+    TCA9548A_SimStats_t stats;
+    muxSim.getStats(stats);
+    CHECK_EQ(stats.forwarded[channels[1]], 0);
+
+    /* State of mux is unknown after failure, so it is selected again */
+    CHECK_EQ(tcs0.getRawData(value), TCS34725_OK);
+    CHECK(isScene(value, 0, 1));
+    muxSim.getStats(stats);
+    CHECK_EQ(stats.selects, 1);
+    CHECK_EQ(stats.unrouted, 0);
+}
+
+static void testArrayIsolation() {
+    TCA9548A_Sim muxSim;
+    TCS34725_Sim sims[SENSORS];
+    setupMux(muxSim, sims);
+    Geegrow_TCS34725_WireBus wireBus(Wire);
+    Geegrow_TCS34725_Mux mux(wireBus);
+    Geegrow_TCS34725_MuxBus buses[SENSORS] = {
+        Geegrow_TCS34725_MuxBus(mux, channels[0]),
+        Geegrow_TCS34725_MuxBus(mux, channels[1]),
+        Geegrow_TCS34725_MuxBus(mux, channels[2])
+    };
+    Geegrow_TCS34725 *sensors[SENSORS];
+    for (uint8_t i = 0; i < SENSORS; i++)
+        sensors[i] = new Geegrow_TCS34725(buses[i], TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_1X);
+    /* Sensor with the darkest scene runs at another setting */
+    sensors[0]->setGain(RN_CONTROL_GAIN_4X);
+
+    Geegrow_TCS34725_Array array(sensors, SENSORS);
+    array.begin();
+    muxSim.resetStats();
+    uint16_t counts[SENSORS] = {};
+    uint16_t wrong = 0;
+    uint32_t start = millis();
+    while (millis() - start < 1000) {
+        uint8_t index;
+        RGBC_value_t value;
+        while (array.poll(index, value)) {
+            CHECK(index < SENSORS);
+            counts[index]++;
+            if (!isScene(value, index, (index == 0) ? 4 : 1))
+                wrong++;
+        }
+        delay(1);
+    }
+    CHECK_EQ(wrong, 0);
+    /* 24 ms cycles, every sensor delivers about 40 samples */
+    for (uint8_t i = 0; i < SENSORS; i++)
+        CHECK(counts[i] >= 40 && counts[i] <= 42);
+    CHECK_EQ(sims[0].getReg(RN_CONTROL), RN_CONTROL_GAIN_4X);
+    CHECK_EQ(sims[1].getReg(RN_CONTROL), RN_CONTROL_GAIN_1X);
+
+    TCA9548A_SimStats_t stats;
+    muxSim.getStats(stats);
+    CHECK_EQ(stats.unrouted, 0);
+    CHECK_EQ(stats.conflicts, 0);
+    for (uint8_t i = 0; i < SENSORS; i++)
+        delete sensors[i];
+}
+
+int main() {
+    RUN_TEST(testSelectBeforeTransaction);
+    RUN_TEST(testNoReselect);
+    RUN_TEST(testSelectFailure);
+    RUN_TEST(testArrayIsolation);
+    return TEST_RESULT();
+}
@@ -0,0 +1,166 @@
+/*!
+ * @file test_palette.cpp
+ *
+ * Checks of palette classification against full search
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include <Geegrow_TCS34725_Palette.h>
+#include <math.h>
+
+static uint32_t distance(const uint8_t *color, int16_t red, int16_t green, int16_t blue) {
+    int32_t dr = red - color[0];
+    int32_t dg = green - color[1];
+    int32_t db = blue - color[2];
+    return dr * dr + dg * dg + db * db;
+}
+
+/* Reference classifier, full search of every class */
+static uint8_t classifyFull(uint8_t colors[][3], uint8_t size, uint8_t maxDistance,
+                            int16_t red, int16_t green, int16_t blue, uint8_t &margin) {
+    uint8_t best = PALETTE_REJECT;
+    uint32_t bestDist = 0xFFFFFFFF, secondDist = 0xFFFFFFFF;
+    for (uint8_t i = 0; i < size; i++) {
+        uint32_t d = distance(colors[i], red, green, blue);
+        if (d < bestDist) {
+            secondDist = bestDist;
+            bestDist = d;
+            best = i;
+        } else if (d < secondDist) {
+            secondDist = d;
+        }
+    }
+    /* Distances are rounded down before comparison */
+    uint16_t bestRoot = (uint16_t)sqrt((double)bestDist);
+    uint16_t m = (uint16_t)sqrt((double)secondDist) - bestRoot;
+    margin = (size < 2 || m > 0xFF) ? 0xFF : m;
+    if (bestRoot > maxDistance)
+        return PALETTE_REJECT;
+    return best;
+}
+
+static void checkPalette(Geegrow_TCS34725_Palette &palette, uint8_t maxDistance) {
+    uint8_t size = palette.getCapacity();
+    uint8_t colors[255][3];
+    palette.clear();
+    for (uint8_t i = 0; i < size; i++) {
+        for (uint8_t c = 0; c < 3; c++)
+            colors[i][c] = random(256);
+        CHECK_EQ(palette.add(colors[i][0], colors[i][1], colors[i][2]), i);
+    }
+    CHECK_EQ(palette.add(0, 0, 0), PALETTE_REJECT);
+    palette.setReject(maxDistance, 0);
+    CHECK(palette.build());
+
+    uint32_t mismatches = 0;
+    for (uint16_t k = 0; k < 4000; k++) {
+        int16_t red, green, blue;
+        if (k & 1) {
+            /* Uniform over the cube */
+            red = random(256);
+            green = random(256);
+            blue = random(256);
+        } else {
+            /* Near some reference color */
+            uint8_t *ref = colors[random(size)];
+            red = ref[0] + random(21) - 10;
+            green = ref[1] + random(21) - 10;
+            blue = ref[2] + random(21) - 10;
+        }
+        uint8_t margin, expectedMargin;
+        uint8_t id = palette.classify(red, green, blue, margin);
+        uint8_t expected = classifyFull(colors, size, maxDistance,
+                                        constrain(red, 0, 255),
+                                        constrain(green, 0, 255),
+                                        constrain(blue, 0, 255), expectedMargin);
+        if (margin != expectedMargin)
+            mismatches++;
+        if (id != expected) {
+            /* Ties may resolve to either class at equal distance */
+            if (id == PALETTE_REJECT || expected == PALETTE_REJECT ||
+                distance(colors[id], red, green, blue) != distance(colors[expected], red, green, blue))
+                mismatches++;
+        }
+    }
+    CHECK_EQ(mismatches, 0u);
+}
+
+static void testUnbounded() {
+    randomSeed(1);
+    Geegrow_TCS34725_StaticPalette<16, 2, 1024> palette;
+    for (uint8_t trial = 0; trial < 20; trial++)
+        checkPalette(palette, 255);
+}
+
+static void testRejectFar() {
+    randomSeed(2);
+    Geegrow_TCS34725_StaticPalette<16, 2, 1024> palette;
+    for (uint8_t trial = 0; trial < 20; trial++)
+        checkPalette(palette, 40);
+}
+
+/* Dense palettes are exact with finer lookup table */
+static void testLargePalette() {
+    randomSeed(3);
+    static Geegrow_TCS34725_StaticPalette<64, 3, 8192> palette64;
+    static Geegrow_TCS34725_StaticPalette<200, 4, 65535> palette200;
+    for (uint8_t trial = 0; trial < 5; trial++) {
+        checkPalette(palette64, 255);
+        checkPalette(palette200, 40);
+    }
+}
+
+/* Longest candidate list does not grow with number of classes while there
+   are as many cells per class */
+static void testFlatLookup() {
+    randomSeed(4);
+    static Geegrow_TCS34725_StaticPalette<8, 2, 512> palette8;
+    static Geegrow_TCS34725_StaticPalette<64, 3, 8192> palette64;
+    static Geegrow_TCS34725_StaticPalette<255, 4, 65535> palette255;
+    Geegrow_TCS34725_Palette *palettes[] = {&palette8, &palette64, &palette255};
+    for (uint8_t p = 0; p < 3; p++) {
+        checkPalette(*palettes[p], 255);
+        printf("  %3u classes: list %5u, longest %u\n", palettes[p]->getSize(),
+            palettes[p]->getListLength(), palettes[p]->getMaxCandidates());
+    }
+    CHECK(palette255.getMaxCandidates() <= palette64.getMaxCandidates() + 8);
+}
+
+static void testListOverflow() {
+    Geegrow_TCS34725_StaticPalette<16, 2, 32> palette;
+    randomSeed(5);
+    for (uint8_t i = 0; i < 16; i++)
+        palette.add(random(256), random(256), random(256));
+    CHECK(!palette.build());
+    CHECK(palette.getListLength() > 32);
+    uint8_t margin;
+    CHECK_EQ(palette.classify(100, 100, 100, margin), PALETTE_REJECT);
+}
+
+static void testExactMatch() {
+    Geegrow_TCS34725_StaticPalette<4, 2, 256> palette;
+    palette.add(255, 0, 0);
+    palette.add(0, 255, 0);
+    palette.add(0, 0, 255);
+    palette.add(255, 255, 255);
+    palette.build();
+    uint8_t margin;
+    CHECK_EQ(palette.classify(250, 5, 5, margin), 0);
+    CHECK(margin > 0);
+    CHECK_EQ(palette.classify(300, 300, 300, margin), 3);
+    CHECK(margin > 0);
+}
+
+int main() {
+    RUN_TEST(testUnbounded);
+    RUN_TEST(testRejectFar);
+    RUN_TEST(testLargePalette);
+    RUN_TEST(testFlatLookup);
+    RUN_TEST(testListOverflow);
+    RUN_TEST(testExactMatch);
+    return TEST_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+/*!
+ * @file test_periodic.cpp
+ *
+ * Checks that periodic and interrupt modes survive power cycle of device
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include "TCS34725_Sim.h"
+#include <Geegrow_TCS34725.h>
+
+static Geegrow_TCS34725 *sensor = nullptr;
+
+static void sensorIsr() {
+    sensor->onInterrupt();
+}
+
+static void testEnableRoundTrip() {
+    TCS34725_Sim sim;
+    sim.setScene(100, 40, 30, 20);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    sensor = &tcs;
+    sim.setIsr(sensorIsr);
+    uint32_t period = tcs.setSamplePeriod(500000UL);
+    Geegrow_TCS34725_StaticSampleBuffer<4> buffer;
+    tcs.beginInterruptMode(buffer);
+    const uint8_t enabled = RN_ENABLE_PON | RN_ENABLE_AEN | RN_ENABLE_WEN | RN_ENABLE_AIEN;
+    CHECK_EQ(sim.getReg(RN_ENABLE), enabled);
+
+    tcs.disable();
+    CHECK_EQ(sim.getReg(RN_ENABLE), enabled & ~RN_ENABLE_PON);
+    tcs.enable();
+    CHECK_EQ(sim.getReg(RN_ENABLE), enabled);
+    CHECK_EQ(tcs.getSamplePeriod(), period);
+
+    /* Device keeps sampling at the period and raising interrupts */
+    TCS34725_SimStats_t stats;
+    sim.resetStats();
+    uint8_t samples = 0;
+    RGBC_value_t value;
+    for (uint16_t ms = 0; ms < 2100; ms++) {
+        tcs.processIRQ();
+        while (tcs.readSample(value))
+            samples++;
+        delay(1);
+    }
+    sim.getStats(stats);
+    /* The first cycle has no wait state before it */
+    CHECK_EQ(stats.cycles, 1 + (2100000UL - tcs.getIntegrationTime_us()) / period);
+    CHECK_EQ(stats.interrupts, stats.cycles);
+    CHECK_EQ(samples, stats.cycles);
+    tcs.endInterruptMode();
+}
+
+static void testEnableWithoutCache() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    tcs.setSamplePeriod(100000UL);
+    tcs.disable();
+    /* State of ENABLE is read back from device when cache is dropped */
+    tcs.refresh();
+    tcs.enable();
+    CHECK_EQ(sim.getReg(RN_ENABLE), RN_ENABLE_PON | RN_ENABLE_AEN | RN_ENABLE_WEN);
+}
+
+/* Result is read as soon as it is latched, before wait state of cycle */
+static void testLatchPhase() {
+    TCS34725_Sim sim;
+    sim.setScene(100, 40, 30, 20);
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    uint32_t period = tcs.setSamplePeriod(500000UL);
+    uint32_t integration = tcs.getIntegrationTime_us();
+    uint32_t start = micros();
+    RGBC_value_t value;
+    for (uint8_t i = 0; i < 4; i++) {
+        if (i == 2)
+            sim.setScene(200, 80, 60, 40);
+        while (!tcs.readIfReady(value))
+            delayMicroseconds(200);
+        /* Latched at the end of integration of cycle i */
+        uint32_t latch = integration + i * period;
+        uint32_t elapsed = micros() - start;
+        CHECK(elapsed >= latch && elapsed < latch + 2000);
+        CHECK_EQ(value.clear, (i < 2) ? 4000 : 8000);
+    }
+    /* Blocking read returns the next latched cycle too */
+    sim.setScene(100, 40, 30, 20);
+    CHECK_EQ(tcs.getRawData(value), TCS34725_OK);
+    uint32_t elapsed = micros() - start;
+    CHECK(elapsed >= integration + 4 * period && elapsed < integration + 4 * period + 2000);
+    CHECK_EQ(value.clear, 4000);
+}
+
+int main() {
+    RUN_TEST(testEnableRoundTrip);
+    RUN_TEST(testEnableWithoutCache);
+    RUN_TEST(testLatchPhase);
+    return TEST_RESULT();
+}
@@ -0,0 +1,127 @@
+/*!
+ * @file test_register_cache.cpp
+ *
+ * Checks bus transactions saved by shadow cache of configuration registers
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include "TCS34725_Sim.h"
+#include <Geegrow_TCS34725.h>
+
+static Host_WireStats_t busSince() {
+    Host_WireStats_t stats;
+    Wire.getStats(stats);
+    Wire.resetStats();
+    return stats;
+}
+
+static void testLimitsBurst() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Wire.resetStats();
+    tcs.setLimitsIRQ(0x1234, 0x0567);
+    Host_WireStats_t bus = busSince();
+    /* Address, command and 4 limit bytes in one write */
+    CHECK_EQ(bus.transactions, 1);
+    CHECK_EQ(bus.writes, 1);
+    CHECK_EQ(bus.bytes, 6);
+    CHECK_EQ(sim.getReg(RN_AILTL), 0x67);
+    CHECK_EQ(sim.getReg(RN_AILTH), 0x05);
+    CHECK_EQ(sim.getReg(RN_AIHTL), 0x34);
+    CHECK_EQ(sim.getReg(RN_AIHTH), 0x12);
+
+    /* Only changed bytes in the middle of burst are sent */
+    tcs.setLimitsIRQ(0x1299, 0x0567);
+    bus = busSince();
+    CHECK_EQ(bus.transactions, 1);
+    CHECK_EQ(bus.bytes, 3);
+    CHECK_EQ(sim.getReg(RN_AIHTL), 0x99);
+}
+
+static void testCachedWriteSkipped() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    tcs.setLimitsIRQ(3000, 1000);
+    tcs.setPersistence(RN_PERS_CONSEQ_VAL_5);
+    Wire.resetStats();
+    TCS34725_SimStats_t device;
+    sim.resetStats();
+
+    /* Values matching the cache produce no transaction */
+    tcs.setLimitsIRQ(3000, 1000);
+    tcs.setPersistence(RN_PERS_CONSEQ_VAL_5);
+    tcs.setGain(RN_CONTROL_GAIN_4X);
+    tcs.setIntegrationTime(RN_ATIME_INTEG_TIME_24);
+    Host_WireStats_t bus = busSince();
+    CHECK_EQ(bus.transactions, 0);
+    sim.getStats(device);
+    CHECK_EQ(device.registerWrites, 0);
+
+    /* Changed value is written once */
+    tcs.setGain(RN_CONTROL_GAIN_16X);
+    tcs.setGain(RN_CONTROL_GAIN_16X);
+    bus = busSince();
+    CHECK_EQ(bus.transactions, 1);
+    CHECK_EQ(sim.getReg(RN_CONTROL), RN_CONTROL_GAIN_16X);
+}
+
+static void testFailedWriteNotCached() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    tcs.setRetries(0);
+    Wire.failWrites(1);
+    tcs.setPersistence(RN_PERS_CONSEQ_VAL_10);
+    CHECK_EQ(tcs.getLastError(), TCS34725_ERR_NACK);
+    CHECK_EQ(sim.getReg(RN_PERS), 0);
+
+    /* Device state is unknown, the same value is sent again */
+    Wire.resetStats();
+    tcs.setPersistence(RN_PERS_CONSEQ_VAL_10);
+    Host_WireStats_t bus = busSince();
+    CHECK_EQ(bus.transactions, 1);
+    CHECK_EQ(sim.getReg(RN_PERS), RN_PERS_CONSEQ_VAL_10);
+}
+
+static void testSyncBursts() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    tcs.setSamplePeriod(100000UL);
+    tcs.setLimitsIRQ(3000, 1000);
+    tcs.setPersistence(RN_PERS_CONSEQ_VAL_5);
+    uint8_t before[SHADOW_SIZE];
+    for (uint8_t reg = 0; reg < SHADOW_SIZE; reg++)
+        before[reg] = sim.getReg(reg);
+
+    /* Brown-out of device, driver restores it from cache */
+    sim.powerCycle();
+    Wire.resetStats();
+    tcs.sync();
+    Host_WireStats_t bus = busSince();
+    /* ATIME, WTIME..AIHTH, PERS..CONFIG, CONTROL, then ENABLE twice */
+    CHECK_EQ(bus.transactions, 6);
+    CHECK_EQ(bus.reads, 0);
+    for (uint8_t reg = 0; reg < SHADOW_SIZE; reg++)
+        if (SHADOW_REGS & (1 << reg))
+            CHECK_EQ(sim.getReg(reg), before[reg]);
+
+    /* Cache holds device state again */
+    tcs.setPersistence(RN_PERS_CONSEQ_VAL_5);
+    bus = busSince();
+    CHECK_EQ(bus.transactions, 0);
+}
+
+int main() {
+    RUN_TEST(testLimitsBurst);
+    RUN_TEST(testCachedWriteSkipped);
+    RUN_TEST(testFailedWriteNotCached);
+    RUN_TEST(testSyncBursts);
+    return TEST_RESULT();
+}
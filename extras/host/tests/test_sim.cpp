@@ -0,0 +1,163 @@
+/*!
+ * @file test_sim.cpp
+ *
+ * Checks of simulated TCS34725 and virtual time, driven by raw transactions
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include "TCS34725_Sim.h"
+#include "defines.h"
+
+static uint8_t isrCount = 0;
+
+static void isr() {
+    isrCount++;
+}
+
+static void writeReg(uint8_t reg, uint8_t value) {
+    Wire.beginTransmission(0x29);
+    Wire.write(RN_COMMAND_CMD | reg);
+    Wire.write(value);
+    Wire.endTransmission();
+}
+
+static uint8_t readReg(uint8_t reg) {
+    Wire.beginTransmission(0x29);
+    Wire.write(RN_COMMAND_CMD | reg);
+    Wire.endTransmission();
+    Wire.requestFrom(0x29, 1);
+    return Wire.read();
+}
+
+static uint16_t readClear() {
+    Wire.beginTransmission(0x29);
+    Wire.write(RN_COMMAND_CMD | RN_COMMAND_TYPE_AUTOINC | RN_CDATAL);
+    Wire.endTransmission();
+    Wire.requestFrom(0x29, 2);
+    uint16_t low = Wire.read();
+    return low | (Wire.read() << 8);
+}
+
+static void testIdentity() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    CHECK_EQ(readReg(RN_ID), RN_ID_ID);
+    CHECK_EQ(readReg(RN_ATIME), 0xFF);
+    /* Unknown address is not acknowledged */
+    Wire.beginTransmission(0x30);
+    CHECK(Wire.endTransmission() != 0);
+}
+
+static void testBusTime() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Wire.setClock(100000);
+    uint64_t start = Host::now();
+    writeReg(RN_ATIME, RN_ATIME_INTEG_TIME_24);
+    /* Start, address, 2 bytes, stop: 29 bits at 10 us */
+    CHECK_EQ(Host::now() - start, 290);
+    Host_WireStats_t stats;
+    Wire.getStats(stats);
+    CHECK_EQ(stats.transactions, 1);
+    CHECK_EQ(stats.bytes, 3);
+}
+
+static void testIntegration() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    sim.setScene(100, 40, 30, 20);
+    writeReg(RN_ATIME, RN_ATIME_INTEG_TIME_24);
+    writeReg(RN_CONTROL, RN_CONTROL_GAIN_4X);
+    writeReg(RN_ENABLE, RN_ENABLE_PON | RN_ENABLE_AEN);
+    CHECK_EQ(readReg(RN_STATUS) & RN_STATUS_AVALID, 0);
+    delay(24);
+    CHECK(readReg(RN_STATUS) & RN_STATUS_AVALID);
+    /* 100 counts per cycle * 4x * 10 cycles */
+    CHECK_EQ(readClear(), 4000);
+
+    /* Bright light saturates at 1024 counts per cycle */
+    sim.setScene(1000, 400, 300, 200);
+    delay(24);
+    CHECK_EQ(readClear(), 10240);
+
+    /* Disabling AEN clears AVALID */
+    writeReg(RN_ENABLE, RN_ENABLE_PON);
+    CHECK_EQ(readReg(RN_STATUS) & RN_STATUS_AVALID, 0);
+}
+
+static void testWaitTime() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    writeReg(RN_ATIME, RN_ATIME_INTEG_TIME_24);
+    writeReg(RN_WTIME, 256 - 10);
+    writeReg(RN_CONFIG, RN_CONFIG_WLONG);
+    writeReg(RN_ENABLE, RN_ENABLE_PON | RN_ENABLE_AEN | RN_ENABLE_WEN);
+    sim.resetStats();
+    /* Cycle is 24 ms of integration and 288 ms of long wait */
+    delay(24 + 3 * 312);
+    TCS34725_SimStats_t stats;
+    sim.getStats(stats);
+    CHECK_EQ(stats.cycles, 4);
+}
+
+static void testThresholds() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    sim.setIsr(isr);
+    isrCount = 0;
+    sim.setScene(100, 40, 30, 20);
+    writeReg(RN_ATIME, RN_ATIME_INTEG_TIME_2_4);
+    writeReg(RN_AILTL, 50);
+    writeReg(RN_AIHTL, 150);
+    writeReg(RN_PERS, RN_PERS_CONSEQ_VAL_3);
+    writeReg(RN_ENABLE, RN_ENABLE_PON | RN_ENABLE_AEN | RN_ENABLE_AIEN);
+    delay(24);
+    CHECK_EQ(isrCount, 0);
+    CHECK(!sim.isIntAsserted());
+
+    /* Out of range twice is not enough, the third cycle asserts INT */
+    sim.setScene(200, 80, 60, 40);
+    delayMicroseconds(2 * 2400);
+    CHECK_EQ(isrCount, 0);
+    delayMicroseconds(2400);
+    CHECK_EQ(isrCount, 1);
+    CHECK(readReg(RN_STATUS) & RN_STATUS_AINT);
+
+    /* INT stays asserted until cleared by special function */
+    delay(24);
+    CHECK_EQ(isrCount, 1);
+    Wire.beginTransmission(0x29);
+    Wire.write(RN_COMMAND_CMD | RN_COMMAND_TYPE_SF | RN_COMMAND_ADDRSF_CLR_IRQ);
+    Wire.endTransmission();
+    CHECK(!sim.isIntAsserted());
+    delayMicroseconds(2400);
+    CHECK_EQ(isrCount, 2);
+}
+
+static void testDeferredInterrupt() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    sim.setIsr(isr);
+    isrCount = 0;
+    writeReg(RN_ATIME, RN_ATIME_INTEG_TIME_2_4);
+    writeReg(RN_ENABLE, RN_ENABLE_PON | RN_ENABLE_AEN | RN_ENABLE_AIEN);
+    noInterrupts();
+    delay(3);
+    CHECK_EQ(isrCount, 0);
+    interrupts();
+    CHECK_EQ(isrCount, 1);
+}
+
+int main() {
+    RUN_TEST(testIdentity);
+    RUN_TEST(testBusTime);
+    RUN_TEST(testIntegration);
+    RUN_TEST(testWaitTime);
+    RUN_TEST(testThresholds);
+    RUN_TEST(testDeferredInterrupt);
+    return TEST_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,297 @@
+/*!
+ * @file test_storage.cpp
+ *
+ * Checks of calibration storage in buffer, file and EEPROM
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include "TCS34725_Sim.h"
+#include <EEPROM.h>
+#include <FileStream.h>
+#include <Geegrow_TCS34725.h>
+
+static const RGBC_value_t table[3] = {
+    {3000, 2500, 2000, 9000},
+    {1500, 1250, 1000, 4500},
+    { 300,  250,  200,  900}
+};
+
+static void testBuffer() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> storage;
+    tcs.setCalibrationStorage(storage);
+    tcs.calibrateManual(table, 3);
+    uint8_t blob[64];
+    uint16_t len = tcs.exportCalibration(blob, sizeof(blob));
+    CHECK_EQ(len, tcs.getCalibrationBlobSize());
+
+    Geegrow_TCS34725 other(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> otherStorage;
+    other.setCalibrationStorage(otherStorage);
+    CHECK(other.importCalibration(blob, len));
+    uint8_t size;
+    const RGBC_value_t *values = other.getCalibrationValues(size);
+    CHECK_EQ(size, 3);
+    CHECK_EQ(values[1].clear, 4500);
+
+    /* Damaged blob is rejected, table is kept */
+    blob[8] ^= 1;
+    other.calibrateManual(table, 2);
+    CHECK(!other.importCalibration(blob, len));
+    other.getCalibrationValues(size);
+    CHECK_EQ(size, 2);
+}
+
+#define CALIB_FILE  "test_storage.bin"
+
+/* CRC-16/CCITT-FALSE as used by blob */
+static uint16_t crc16(const uint8_t *data, uint16_t len) {
+    uint16_t crc = 0xFFFF;
+    for (uint16_t n = 0; n < len; n++) {
+        crc ^= (uint16_t)data[n] << 8;
+        for (uint8_t i = 0; i < 8; i++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+static void writeFile(const uint8_t *data, uint16_t len) {
+    Host_FileStream file;
+    CHECK(file.open(CALIB_FILE, "w"));
+    CHECK_EQ(file.write(data, len), len);
+}
+
+static void testFile() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> storage;
+    tcs.setCalibrationStorage(storage);
+    tcs.calibrateManual(table, 3);
+    Host_FileStream file;
+    CHECK(file.open(CALIB_FILE, "w"));
+    CHECK_EQ(tcs.writeCalibration(file), tcs.getCalibrationBlobSize());
+    file.close();
+
+    Geegrow_TCS34725 other(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> otherStorage;
+    other.setCalibrationStorage(otherStorage);
+    RGBC_value_t staging[CALIB_TABLE_SIZE];
+    CHECK(file.open(CALIB_FILE, "r"));
+    CHECK(other.readCalibration(file, staging, CALIB_TABLE_SIZE));
+    CHECK_EQ(file.available(), 0);
+    file.close();
+    uint8_t size;
+    const RGBC_value_t *values = other.getCalibrationValues(size);
+    CHECK_EQ(size, 3);
+    for (uint8_t i = 0; i < 3; i++) {
+        CHECK_EQ(values[i].clear, table[i].clear);
+        CHECK_EQ(values[i].red, table[i].red);
+        CHECK_EQ(values[i].blue, table[i].blue);
+    }
+    int16_t red, green, blue;
+    other.convertRGB_255(table[1], red, green, blue);
+    CHECK_EQ(red, 255);
+
+    /* Staging array too small for the blob */
+    CHECK(file.open(CALIB_FILE, "r"));
+    CHECK(!other.readCalibration(file, staging, 2));
+    file.close();
+    remove(CALIB_FILE);
+}
+
+static void testCorruptFile() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> storage;
+    tcs.setCalibrationStorage(storage);
+    tcs.calibrateManual(table, 3);
+    uint8_t blob[64];
+    uint16_t len = tcs.exportCalibration(blob, sizeof(blob));
+    RGBC_value_t staging[CALIB_TABLE_SIZE];
+    uint8_t size;
+    const RGBC_value_t *values;
+
+    /* Damaged row: valid table is kept */
+    Geegrow_TCS34725 other(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> otherStorage;
+    other.setCalibrationStorage(otherStorage);
+    other.calibrateManual(table + 1, 2);
+    uint8_t bad[64];
+    memcpy(bad, blob, len);
+    bad[10] ^= 0x40;
+    writeFile(bad, len);
+    Host_FileStream file;
+    CHECK(file.open(CALIB_FILE, "r"));
+    CHECK(!other.readCalibration(file, staging, CALIB_TABLE_SIZE));
+    file.close();
+    values = other.getCalibrationValues(size);
+    CHECK_EQ(size, 2);
+    CHECK_EQ(values[0].clear, 4500);
+    int16_t red, green, blue;
+    other.convertRGB_255(table[1], red, green, blue);
+    CHECK_EQ(red, 255);
+
+    /* Truncated blob */
+    writeFile(blob, len - 3);
+    CHECK(file.open(CALIB_FILE, "r"));
+    CHECK(!other.readCalibration(file, staging, CALIB_TABLE_SIZE));
+    file.close();
+    other.getCalibrationValues(size);
+    CHECK_EQ(size, 2);
+
+    /* Rows out of clear order are rejected even with valid CRC */
+    memcpy(bad, blob, len);
+    for (uint8_t i = 0; i < 8; i++) {
+        uint8_t t = bad[6 + i];
+        bad[6 + i] = bad[14 + i];
+        bad[14 + i] = t;
+    }
+    uint16_t crc = crc16(bad, len - 2);
+    bad[len - 2] = crc & 0xFF;
+    bad[len - 1] = crc >> 8;
+    CHECK(!other.importCalibration(bad, len));
+    writeFile(bad, len);
+    CHECK(file.open(CALIB_FILE, "r"));
+    CHECK(!other.readCalibration(file, staging, CALIB_TABLE_SIZE));
+    file.close();
+    values = other.getCalibrationValues(size);
+    CHECK_EQ(size, 2);
+    CHECK_EQ(values[0].clear, 4500);
+    remove(CALIB_FILE);
+}
+
+/* Table that can't be loaded back is never written */
+static void testMinimalTable() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> storage;
+    tcs.setCalibrationStorage(storage);
+    RGBC_value_t staging[1];
+    tcs.beginCalibration(staging, 1, 0);
+    CHECK(!tcs.isCalibrating());
+    tcs.addCalibrationSample(table[0]);
+    uint8_t blob[64];
+    CHECK_EQ(tcs.getCalibrationBlobSize(), 0);
+    CHECK_EQ(tcs.exportCalibration(blob, sizeof(blob)), 0);
+
+    /* Recorded table of minimal size round trips */
+    RGBC_value_t samples[MIN_CALIB_TABLE_SIZE];
+    tcs.beginCalibration(samples, MIN_CALIB_TABLE_SIZE, 0);
+    RGBC_value_t value;
+    while (tcs.isCalibrating())
+        CHECK_EQ(tcs.getRawData(value), TCS34725_OK);
+    uint16_t len = tcs.exportCalibration(blob, sizeof(blob));
+    CHECK(len > 0);
+    Geegrow_TCS34725 other(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> otherStorage;
+    other.setCalibrationStorage(otherStorage);
+    CHECK(other.importCalibration(blob, len));
+    uint8_t size;
+    other.getCalibrationValues(size);
+    CHECK_EQ(size, MIN_CALIB_TABLE_SIZE);
+}
+
+static void testEeprom() {
+    TCS34725_Sim sim;
+    sim.attach(Wire);
+    EEPROM.erase();
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> storage;
+    tcs.setCalibrationStorage(storage);
+    CHECK(!tcs.loadCalibration(16));
+    tcs.calibrateManual(table, 3);
+    CHECK(tcs.saveCalibration(16));
+
+    Geegrow_TCS34725 other(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> otherStorage;
+    other.setCalibrationStorage(otherStorage);
+    CHECK(other.loadCalibration(16));
+    uint8_t size;
+    other.getCalibrationValues(size);
+    CHECK_EQ(size, 3);
+
+    /* Table is valid only for configuration it was taken with */
+    Geegrow_TCS34725 slow(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> slowStorage;
+    slow.setCalibrationStorage(slowStorage);
+    CHECK(!slow.loadCalibration(16));
+}
+
+/* Runs a few cycles of calibration started before the table is loaded */
+static void startCalibration(Geegrow_TCS34725 &tcs, RGBC_value_t *staging) {
+    RGBC_value_t value;
+    tcs.beginCalibration(staging, 4, 0);
+    CHECK_EQ(tcs.getRawData(value), TCS34725_OK);
+    CHECK_EQ(tcs.getRawData(value), TCS34725_OK);
+    CHECK(tcs.isCalibrating());
+}
+
+/* Loaded table stays after the cycles calibration would have finished in */
+static void checkLoaded(Geegrow_TCS34725 &tcs) {
+    CHECK(!tcs.isCalibrating());
+    RGBC_value_t value;
+    for (uint8_t i = 0; i < 4; i++)
+        CHECK_EQ(tcs.getRawData(value), TCS34725_OK);
+    uint8_t size;
+    const RGBC_value_t *values = tcs.getCalibrationValues(size);
+    CHECK_EQ(size, 3);
+    CHECK_EQ(values[0].clear, table[0].clear);
+}
+
+static void testLoadCancelsCalibration() {
+    TCS34725_Sim sim;
+    sim.setScene(100, 40, 30, 20);
+    sim.attach(Wire);
+    EEPROM.erase();
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    Geegrow_TCS34725_CalibStorage<CALIB_TABLE_SIZE> storage;
+    tcs.setCalibrationStorage(storage);
+    tcs.calibrateManual(table, 3);
+    uint8_t blob[64];
+    uint16_t len = tcs.exportCalibration(blob, sizeof(blob));
+    CHECK(tcs.saveCalibration(16));
+    writeFile(blob, len);
+
+    RGBC_value_t staging[4];
+    startCalibration(tcs, staging);
+    CHECK(tcs.importCalibration(blob, len));
+    checkLoaded(tcs);
+
+    startCalibration(tcs, staging);
+    Host_FileStream file;
+    RGBC_value_t rows[CALIB_TABLE_SIZE];
+    CHECK(file.open(CALIB_FILE, "r"));
+    CHECK(tcs.readCalibration(file, rows, CALIB_TABLE_SIZE));
+    file.close();
+    checkLoaded(tcs);
+    remove(CALIB_FILE);
+
+    startCalibration(tcs, staging);
+    CHECK(tcs.loadCalibration(16));
+    checkLoaded(tcs);
+
+    /* Damaged blob doesn't stop calibration */
+    startCalibration(tcs, staging);
+    blob[8] ^= 1;
+    CHECK(!tcs.importCalibration(blob, len));
+    CHECK(tcs.isCalibrating());
+}
+
+int main() {
+    RUN_TEST(testBuffer);
+    RUN_TEST(testFile);
+    RUN_TEST(testCorruptFile);
+    RUN_TEST(testMinimalTable);
+    RUN_TEST(testEeprom);
+    RUN_TEST(testLoadCancelsCalibration);
+    return TEST_RESULT();
+}
\ No newline at end of file
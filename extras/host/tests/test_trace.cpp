@@ -0,0 +1,269 @@
+/*!
+ * @file test_trace.cpp
+ *
+ * Checks that replay of recorded trace reproduces live processing
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "HostTest.h"
+#include "TCS34725_Sim.h"
+#include "FileStream.h"
+#include <Geegrow_TCS34725.h>
+#include <Geegrow_TCS34725_Filter.h>
+#include <Geegrow_TCS34725_Trace.h>
+
+#define SAMPLES        200
+#define TRACE_SIZE     8192
+#define TRACE_FILE     "test_trace.bin"
+
+/* Output which keeps whole trace in memory and never blocks */
+class MemoryPrint : public Print {
+    public:
+        size_t write(uint8_t b) override {
+            if (this->len >= TRACE_SIZE)
+                return 0;
+            this->data[this->len++] = b;
+            return 1;
+        }
+        int availableForWrite() override { return TRACE_SIZE - this->len; }
+
+        uint8_t data[TRACE_SIZE];
+        uint32_t len = 0;
+};
+
+/* Replay target set up as the live driver */
+struct ReplayDriver {
+    Geegrow_TCS34725_NullBus bus;
+    Geegrow_TCS34725 tcs;
+    Geegrow_TCS34725_Filter filter;
+    Geegrow_TCS34725_CalibStorage<2> calib;
+
+    ReplayDriver() : tcs(bus, TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X) {
+        this->tcs.setCalibrationStorage(this->calib);
+        this->filter.setMode(FILTER_EMA, 2);
+        this->tcs.setFilter(&this->filter);
+        this->tcs.setAutoRange(true);
+    }
+};
+
+static const RGBC_value_t table[2] = {
+    {2000, 2000, 2000, 6000},
+    {100, 100, 100, 300}
+};
+
+static RGBC_value_t live[SAMPLES];
+static uint32_t replayed = 0;
+static uint32_t mismatches = 0;
+static uint32_t lastTime = 0;
+
+static void onSample(uint32_t time, const RGBC_value_t &raw, const RGBC_value_t &value) {
+    (void)raw;
+    if (replayed >= SAMPLES || time < lastTime) {
+        mismatches++;
+        return;
+    }
+    lastTime = time;
+    const RGBC_value_t &expected = live[replayed++];
+    if (value.red != expected.red || value.green != expected.green ||
+        value.blue != expected.blue || value.clear != expected.clear)
+        mismatches++;
+}
+
+static void setupSim(TCS34725_Sim &sim) {
+    sim.setScene(100, 40, 30, 20);
+    sim.setNoise(30, 5);
+    sim.attach(Wire);
+}
+
+/* Live run: scene steps over two decades so auto-range switches */
+static void recordLive(TCS34725_Sim &sim, Geegrow_TCS34725 &tcs, Geegrow_TCS34725_TraceWriter &writer, Print &out) {
+    static Geegrow_TCS34725_Filter liveFilter;
+    static Geegrow_TCS34725_CalibStorage<2> liveCalib;
+    liveFilter.setMode(FILTER_EMA, 2);
+    liveFilter.reset();
+    tcs.setFilter(&liveFilter);
+    tcs.setAutoRange(true);
+    tcs.setCalibrationStorage(liveCalib);
+    tcs.calibrateManual(table, 2);
+    writer.begin(out);
+    tcs.setTraceWriter(&writer);
+    for (uint16_t i = 0; i < SAMPLES; i++) {
+        if (i % 40 == 0)
+            sim.setScene((i % 80) ? 5 : 500, 40, 30, 20);
+        CHECK_EQ(tcs.getRawData(live[i]), TCS34725_OK);
+        writer.poll();
+    }
+    writer.flush();
+    tcs.setTraceWriter(nullptr);
+    CHECK_EQ(writer.getDropped(), 0);
+}
+
+static void resetReplay() {
+    replayed = 0;
+    mismatches = 0;
+    lastTime = 0;
+}
+
+static void testReplay() {
+    static MemoryPrint out;
+    Geegrow_TCS34725_StaticTraceWriter<64> writer;
+    TCS34725_Sim sim;
+    setupSim(sim);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    recordLive(sim, tcs, writer, out);
+
+    /* Initial configuration and auto-range switches are recorded */
+    Geegrow_TCS34725_TraceReader reader;
+    CHECK(reader.begin(out.data, out.len));
+    TraceRecord_t record;
+    uint8_t type;
+    uint16_t configs = 0;
+    while ((type = reader.next(record)) == TRACE_SAMPLE || type == TRACE_CONFIG)
+        configs += (type == TRACE_CONFIG);
+    CHECK_EQ(type, TRACE_END);
+    CHECK(configs > 1);
+
+    /* Replay on a driver without device, set up as the live one */
+    ReplayDriver replay;
+    replay.tcs.calibrateManual(table, 2);
+    resetReplay();
+    uint32_t samples;
+    CHECK(reader.begin(out.data, out.len));
+    CHECK_EQ(reader.replay(replay.tcs, onSample, samples), TRACE_END);
+    CHECK_EQ(samples, SAMPLES);
+    CHECK_EQ(replayed, SAMPLES);
+    CHECK_EQ(mismatches, 0);
+    CHECK_EQ(replay.tcs.getIntegrationTime_us(), tcs.getIntegrationTime_us());
+
+    /* Conversion through calibration table matches too */
+    int16_t r1, g1, b1, r2, g2, b2;
+    tcs.convertRGB_255(live[SAMPLES - 1], r1, g1, b1);
+    replay.tcs.convertRGB_255(live[SAMPLES - 1], r2, g2, b2);
+    CHECK_EQ(r1, r2);
+    CHECK_EQ(g1, g2);
+    CHECK_EQ(b1, b2);
+}
+
+/* Trace written to file and replayed from it through Stream */
+static void testFileReplay() {
+    Host_FileStream file;
+    Geegrow_TCS34725_StaticTraceWriter<64> writer;
+    TCS34725_Sim sim;
+    setupSim(sim);
+    Geegrow_TCS34725 tcs(TCS34725_I2C_ADDRESS, RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X);
+    CHECK(file.open(TRACE_FILE, "w"));
+    recordLive(sim, tcs, writer, file);
+    file.close();
+
+    ReplayDriver replay;
+    replay.tcs.calibrateManual(table, 2);
+    resetReplay();
+    Geegrow_TCS34725_TraceReader reader;
+    uint32_t samples;
+    CHECK(file.open(TRACE_FILE, "r"));
+    CHECK(reader.begin(file));
+    CHECK_EQ(reader.replay(replay.tcs, onSample, samples), TRACE_END);
+    CHECK_EQ(samples, SAMPLES);
+    CHECK_EQ(mismatches, 0);
+    file.close();
+    remove(TRACE_FILE);
+}
+
+/* Writer sends nothing until flush(), so small buffer overflows */
+static void testDroppedSamples() {
+    static MemoryPrint out;
+    out.len = 0;
+    Geegrow_TCS34725_StaticTraceWriter<32> writer;
+    writer.begin(out);
+    writer.recordConfig(RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X, 0);
+    RGBC_value_t value = {100, 100, 100, 300};
+    for (uint8_t i = 0; i < 10; i++)
+        writer.recordSample(value, i * 24000UL);
+    CHECK(writer.getDropped() > 0);
+    uint16_t dropped = writer.getDropped();
+    writer.flush();
+    writer.recordSample(value, 240000UL);
+    writer.flush();
+
+    Geegrow_TCS34725_TraceReader reader;
+    CHECK(reader.begin(out.data, out.len));
+    TraceRecord_t record;
+    uint8_t type;
+    uint16_t samples = 0, drops = 0;
+    while ((type = reader.next(record)) != TRACE_END && type != TRACE_ERROR) {
+        if (type == TRACE_SAMPLE) {
+            samples++;
+            CHECK_EQ(record.value.clear, 300);
+        } else if (type == TRACE_DROP) {
+            drops++;
+            CHECK_EQ(record.dropped, dropped);
+            CHECK(!record.configLost);
+        }
+    }
+    CHECK_EQ(type, TRACE_END);
+    CHECK_EQ(drops, 1);
+    CHECK_EQ(samples + dropped, 11);
+    CHECK_EQ(record.time, 240000UL);
+
+    /* Lost samples don't stop replay */
+    ReplayDriver replay;
+    uint32_t replayedSamples;
+    CHECK(reader.begin(out.data, out.len));
+    CHECK_EQ(reader.replay(replay.tcs, nullptr, replayedSamples), TRACE_END);
+    CHECK_EQ(replayedSamples, samples);
+}
+
+static void testDroppedConfig() {
+    static MemoryPrint out;
+    out.len = 0;
+    Geegrow_TCS34725_StaticTraceWriter<32> writer;
+    writer.begin(out);
+    writer.recordConfig(RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X, 0);
+    RGBC_value_t value = {100, 100, 100, 300};
+    for (uint8_t i = 0; i < 4; i++)
+        writer.recordSample(value, i * 24000UL);
+    writer.recordConfig(RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_16X, 100000UL);
+    CHECK(writer.getDropped() > 0);
+    writer.flush();
+    writer.recordSample(value, 120000UL);
+    writer.flush();
+
+    Geegrow_TCS34725_TraceReader reader;
+    CHECK(reader.begin(out.data, out.len));
+    TraceRecord_t record;
+    uint8_t type;
+    bool configLost = false;
+    while ((type = reader.next(record)) != TRACE_END && type != TRACE_ERROR)
+        if (type == TRACE_DROP)
+            configLost = record.configLost;
+    CHECK(configLost);
+
+    /* Samples after lost configuration are not replayed */
+    ReplayDriver replay;
+    uint32_t samples;
+    CHECK(reader.begin(out.data, out.len));
+    CHECK_EQ(reader.replay(replay.tcs, nullptr, samples), TRACE_ERROR);
+    CHECK(samples < 5);
+}
+
+static void testTruncated() {
+    const uint8_t trace[] = {'G', 'T', TRACE_VERSION, TRACE_SAMPLE, 10, 2};
+    Geegrow_TCS34725_TraceReader reader;
+    CHECK(reader.begin(trace, sizeof(trace)));
+    TraceRecord_t record;
+    CHECK_EQ(reader.next(record), TRACE_ERROR);
+    const uint8_t bad[] = {'G', 'X', TRACE_VERSION};
+    CHECK(!reader.begin(bad, sizeof(bad)));
+}
+
+int main() {
+    RUN_TEST(testReplay);
+    RUN_TEST(testFileReplay);
+    RUN_TEST(testDroppedSamples);
+    RUN_TEST(testDroppedConfig);
+    RUN_TEST(testTruncated);
+    return TEST_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+/*!
+ * @file replay.cpp
+ *
+ * Replays trace file recorded by Geegrow_TCS34725_TraceWriter through the
+ * driver on host and prints raw and processed samples as CSV
+ *
+ *     tcs34725_replay [-a] [-e N] [-c calib.bin] trace.bin
+ *
+ * -a enables auto-ranging, -e N exponential filter with alpha = 1 / 2^N,
+ * they must match the recording driver for bit-exact results. Driver is
+ * set up with configuration of the first record, so auto-ranging starts
+ * from the same reference as in a sketch attaching the writer right after
+ * setAutoRange(). -c loads calibration blob written by writeCalibration()
+ * and adds columns of convertRGB_255(). Exit code is 0 if the whole trace
+ * is replayed, 1 if it is damaged, configuration records were lost by
+ * writer or calibration doesn't match configuration
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Geegrow_TCS34725.h>
+#include <Geegrow_TCS34725_Filter.h>
+#include <Geegrow_TCS34725_Trace.h>
+#include "FileStream.h"
+
+/* Set only when calibration is loaded */
+static Geegrow_TCS34725 *calibrated = nullptr;
+
+static void printSample(uint32_t time, const RGBC_value_t &raw, const RGBC_value_t &value) {
+    printf("%u,%u,%u,%u,%u,%u,%u,%u,%u", time,
+        raw.red, raw.green, raw.blue, raw.clear,
+        value.red, value.green, value.blue, value.clear);
+    if (calibrated) {
+        int16_t red, green, blue;
+        calibrated->convertRGB_255(value, red, green, blue);
+        printf(",%d,%d,%d", red, green, blue);
+    }
+    printf("\n");
+}
+
+static int usage() {
+    fprintf(stderr, "usage: tcs34725_replay [-a] [-e N] [-c calib.bin] trace.bin\n");
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    bool autoRange = false;
+    int ema = -1;
+    const char *calibPath = nullptr;
+    const char *path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-a"))
+            autoRange = true;
+        else if (!strcmp(argv[i], "-e") && i + 1 < argc)
+            ema = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+            calibPath = argv[++i];
+        else if (argv[i][0] != '-' && !path)
+            path = argv[i];
+        else
+            return usage();
+    }
+    if (!path)
+        return usage();
+
+    Host_FileStream file;
+    if (!file.open(path, "r")) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return 1;
+    }
+    Geegrow_TCS34725_TraceReader reader;
+    if (!reader.begin(file)) {
+        fprintf(stderr, "%s: not a trace of version %u\n", path, TRACE_VERSION);
+        return 1;
+    }
+
+    /* Writer starts trace with configuration of driver */
+    TraceRecord_t first;
+    if (reader.next(first) != TRACE_CONFIG) {
+        fprintf(stderr, "%s: no initial configuration\n", path);
+        return 1;
+    }
+    Geegrow_TCS34725_NullBus bus;
+    Geegrow_TCS34725 tcs(bus, TCS34725_I2C_ADDRESS, first.atime, first.gain);
+    Geegrow_TCS34725_Filter filter;
+    if (ema >= 0) {
+        filter.setMode(FILTER_EMA, ema);
+        tcs.setFilter(&filter);
+    }
+    tcs.setAutoRange(autoRange);
+
+    /* Blob is checked against configuration, so it is loaded after it */
+    if (calibPath) {
+        static Geegrow_TCS34725_CalibStorage<255> calib;
+        static RGBC_value_t staging[255];
+        Host_FileStream calibFile;
+        tcs.setCalibrationStorage(calib);
+        if (!calibFile.open(calibPath, "r") || !tcs.readCalibration(calibFile, staging, 255)) {
+            fprintf(stderr, "%s: no calibration for configuration of trace\n", calibPath);
+            return 1;
+        }
+        calibrated = &tcs;
+    }
+
+    printf("time_us,raw_r,raw_g,raw_b,raw_c,r,g,b,c%s\n", calibrated ? ",r255,g255,b255" : "");
+    uint32_t samples;
+    uint8_t result = reader.replay(tcs, printSample, samples);
+    fprintf(stderr, "%s: %u samples", path, samples);
+    if (result == TRACE_ERROR) {
+        fprintf(stderr, ", damaged trace or lost configuration\n");
+        return 1;
+    }
+    fprintf(stderr, "\n");
+    return 0;
+}
@@ -14,6 +14,33 @@
 
 #include "Geegrow_TCS34725.h"
 
+/******************************************************************************/
+/*!
+    @brief    Get transport used by default, over global Wire
+    @return   Reference to transport
+    @note     Transport is created on first use, so global sensor objects
+              don't depend on order of initialization of translation units
+ */
+/******************************************************************************/
+static Geegrow_TCS34725_WireBus &getDefaultBus() {
+    static Geegrow_TCS34725_WireBus bus(Wire);
+    return bus;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Decodes RGBC data registers
+    @param    buf     Pointer to values of CDATAL..BDATAH
+    @param    value   Reference to structure for RGBC values
+ */
+/******************************************************************************/
+static void unpackRGBC(const uint8_t *buf, RGBC_value_t &value) {
+    value.clear = ((uint16_t)buf[1] << 8) | buf[0];
+    value.red   = ((uint16_t)buf[3] << 8) | buf[2];
+    value.green = ((uint16_t)buf[5] << 8) | buf[4];
+    value.blue  = ((uint16_t)buf[7] << 8) | buf[6];
+}
+
 /******************************************************************************/
 /*!
     @brief    Constructor
@@ -22,9 +49,23 @@
     @param    gain    Gain value
  */
 /******************************************************************************/
-Geegrow_TCS34725::Geegrow_TCS34725(uint8_t addr, uint8_t time, uint8_t gain) {
+Geegrow_TCS34725::Geegrow_TCS34725(uint8_t addr, uint8_t time, uint8_t gain)
+    : Geegrow_TCS34725(getDefaultBus(), addr, time, gain) {
+}
+
+/******************************************************************************/
+/*!
+    @brief    Constructor
+    @param    bus     Transport for register access
+    @param    addr    I2C address of device
+    @param    time    Intergration time for RGBC
+    @param    gain    Gain value
+ */
+/******************************************************************************/
+Geegrow_TCS34725::Geegrow_TCS34725(Geegrow_TCS34725_Bus &bus, uint8_t addr, uint8_t time, uint8_t gain) {
     this->i2c_addr = addr;
-    Wire.begin();
+    this->bus = &bus;
+    this->bus->begin();
     this->setIntegrationTime(time);
     this->setGain(gain);
     this->enable();
@@ -33,22 +74,35 @@ Geegrow_TCS34725::Geegrow_TCS34725(uint8_t addr, uint8_t time, uint8_t gain) {
 /******************************************************************************/
 /*!
     @brief    Enables power on device and switches on ADCs
+    @note     Register is changed by read-modify-write, so wait state and
+              interrupts stay enabled. Nothing is written if read fails,
+              see getLastError()
  */
 /******************************************************************************/
 void Geegrow_TCS34725::enable() {
-    this->I2C_write_8(RN_ENABLE, RN_ENABLE_PON);
+    uint8_t t;
+    if (this->readReg(RN_ENABLE, t) != TCS34725_OK)
+        return;
+    this->writeReg(RN_ENABLE, (t | RN_ENABLE_PON) & ~RN_ENABLE_AEN);
     delay(3);
-    this->I2C_write_8(RN_ENABLE, RN_ENABLE_PON | RN_ENABLE_AEN);
+    this->writeReg(RN_ENABLE, t | RN_ENABLE_PON | RN_ENABLE_AEN);
+    this->conversionStart = micros();
+    this->conversionActive = true;
 }
 
 /******************************************************************************/
 /*!
     @brief    Disables power on device and switches off ADCs
+    @note     Register is changed by read-modify-write, nothing is written if
+              read fails, see getLastError()
  */
 /******************************************************************************/
 void Geegrow_TCS34725::disable() {
-    uint8_t t = this->I2C_read_8(RN_ENABLE);
-    this->I2C_write_8(RN_ENABLE, t & (~RN_ENABLE_PON));
+    uint8_t t;
+    if (this->readReg(RN_ENABLE, t) != TCS34725_OK)
+        return;
+    this->writeReg(RN_ENABLE, t & (~RN_ENABLE_PON));
+    this->conversionActive = false;
 }
 
 /******************************************************************************/
@@ -58,15 +112,129 @@ void Geegrow_TCS34725::disable() {
     @param    green   Reference to variable for green color
     @param    blue    Reference to variable for blue color
     @param    clear   Reference to variable for sum of colors
+    @return   TCS34725_OK or error code
     @note     There is a delay in this function for getting a valid RGBC value
  */
 /******************************************************************************/
-void Geegrow_TCS34725::getRawData(int16_t &red, int16_t &green, int16_t &blue, int16_t &clear) {
-    delay(this->currentIntegrationTime);
-    red   = this->I2C_read_16(RN_RDATAL);
-    green = this->I2C_read_16(RN_GDATAL);
-    blue  = this->I2C_read_16(RN_BDATAL);
-    clear = this->I2C_read_16(RN_CDATAL);
+uint8_t Geegrow_TCS34725::getRawData(int16_t &red, int16_t &green, int16_t &blue, int16_t &clear) {
+    RGBC_value_t value;
+    uint8_t status = this->getRawData(value);
+    red   = value.red;
+    green = value.green;
+    blue  = value.blue;
+    clear = value.clear;
+    return status;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Reads actual data from sensor in one bus transaction
+    @param    value   Reference to structure for RGBC values
+    @return   TCS34725_OK or error code, value is zeroed on error
+    @note     Function blocks only until the running integration cycle
+              completes. If a fresh result is already latched, it returns
+              immediately. Waiting is limited by cycle period plus timeout
+              set by setTimeout(). Samples clipped with auto-ranging are
+              skipped, so one more cycle may be waited for
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725::getRawData(RGBC_value_t &value) {
+    uint32_t start = micros();
+    uint8_t status = TCS34725_OK;
+    this->lastError = TCS34725_OK;
+    if (!this->conversionActive)
+        this->startConversion();
+    while (!this->readIfReady(value)) {
+        if (this->lastError != TCS34725_OK) {
+            status = this->lastError;
+            break;
+        }
+        if ((int32_t)(micros() - this->conversionStart) > (int32_t)(this->getIntegrationTime_us() + this->timeout * 1000UL)) {
+            status = TCS34725_ERR_TIMEOUT;
+            this->lastError = status;
+            this->stats.timeouts++;
+            break;
+        }
+    }
+    this->stats.waitTime += micros() - start;
+    if (status != TCS34725_OK)
+        value.red = value.green = value.blue = value.clear = 0;
+    return status;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Restarts RGBC integration cycle without blocking
+    @note     Nothing is written if ENABLE register can't be read, see
+              getLastError()
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::startConversion() {
+    uint8_t t;
+    if (this->readReg(RN_ENABLE, t) != TCS34725_OK)
+        return;
+    this->writeReg(RN_ENABLE, t & ~RN_ENABLE_AEN);
+    this->writeReg(RN_ENABLE, t | RN_ENABLE_PON | RN_ENABLE_AEN);
+    this->conversionStart = micros();
+    this->conversionActive = true;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Checks if a fresh RGBC result is available
+    @return   True if integration cycle is completed and AVALID is set
+    @note     No bus transaction is made before integration time expires
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725::isReady() {
+    if (!this->isDue())
+        return false;
+    uint8_t status = 0;
+    if (this->I2C_read_8(RN_STATUS, status) != TCS34725_OK)
+        return false;
+    return status & RN_STATUS_AVALID;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Reads RGBC values if a fresh result is available
+    @param    value   Reference to structure for RGBC values
+    @return   True if value was updated
+    @note     No bus transaction is made before integration time expires,
+              then STATUS and RGBC registers are read in one transaction.
+              On bus error false is returned, see getLastError(). With
+              auto-ranging a clipped sample is dropped, false is returned and
+              the next cycle runs with less sensitive settings
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725::readIfReady(RGBC_value_t &value) {
+    if (!this->isDue())
+        return false;
+    uint32_t now = micros();
+    bool valid;
+    if (this->readStatusRGBC(value, valid) != TCS34725_OK || !valid)
+        return false;
+    /* Device keeps cycling, results are latched at the end of integration,
+       wait state follows it. Deadline moves to the end of integration of
+       the cycle after the one just read */
+    if (this->currentCyclePeriod) {
+        uint32_t late = now - this->conversionStart - this->getIntegrationTime_us();
+        this->conversionStart += (late / this->currentCyclePeriod + 1) * this->currentCyclePeriod;
+    }
+    return this->processSample(value);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Checks if awaited integration cycle has ended
+    @return   True if result of the cycle must be latched by now
+    @note     Start of the cycle may be ahead while device is in wait state
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725::isDue() {
+    if (!this->conversionActive)
+        return false;
+    return (int32_t)(micros() - this->conversionStart) >= (int32_t)this->getIntegrationTime_us();
 }
 
 /******************************************************************************/
@@ -75,62 +243,147 @@ void Geegrow_TCS34725::getRawData(int16_t &red, int16_t &green, int16_t &blue, i
     @param    red     Reference to variable for red color
     @param    green   Reference to variable for green color
     @param    blue    Reference to variable for blue color
+    @return   TCS34725_OK or error code
  */
 /******************************************************************************/
-void Geegrow_TCS34725::getRGB_255(int16_t &red, int16_t &green, int16_t &blue) {
-    int16_t temp_red, temp_green, temp_blue, temp_clear;
-    this->getRawData(temp_red, temp_green, temp_blue, temp_clear);
+uint8_t Geegrow_TCS34725::getRGB_255(int16_t &red, int16_t &green, int16_t &blue) {
+    RGBC_value_t value;
+    uint8_t status = this->getRawData(value);
+    this->convertRGB_255(value, red, green, blue);
+    return status;
+}
 
-    if (temp_clear == 0) {
+/******************************************************************************/
+/*!
+    @brief    Reduces fixed-point value to 16-bit mantissa
+    @param    value   Value, real value is value >> shift
+    @param    shift   Reference to shift, decreased by dropped bits
+    @return   Mantissa
+ */
+/******************************************************************************/
+static uint16_t normalize16(uint32_t value, int8_t &shift) {
+    while (value > 0xFFFF) {
+        value >>= 1;
+        shift--;
+    }
+    return value;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Converts raw RGBC values to 255 format using calibration table
+    @param    value   Reference to structure with raw RGBC values
+    @param    red     Reference to variable for red color
+    @param    green   Reference to variable for green color
+    @param    blue    Reference to variable for blue color
+    @note     Only integer multiply and shift are used per sample, scales
+              are precomputed during calibration. Row is found by binary
+              search, scale is linearly interpolated between adjacent rows
+              by clear value and applied once, so only the result saturates
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::convertRGB_255(const RGBC_value_t &value, int16_t &red, int16_t &green, int16_t &blue) {
+    if (value.clear == 0 || this->calibTableSize == 0) {
         red = green = blue = 0;
         return;
     }
 
-    float clearDiv = this->calibValues[0].clear / (float)temp_clear;
-    uint8_t calibIdx = 0;
-    for (uint8_t i = this->calibTableSize - 1; i > 0; i--) {
-        if (clearDiv > this->calibCoef[i][3]) {
-            calibIdx = i;
-            break;
+    /* Find rows around the sample: clear[lo] > value.clear >= clear[hi] */
+    const uint8_t last = this->calibTableSize - 1;
+    uint8_t lo = 0, hi = last;
+    if (value.clear >= this->calibValues[0].clear) {
+        hi = 0;
+    } else if (value.clear <= this->calibValues[last].clear) {
+        lo = last;
+    } else {
+        while (hi - lo > 1) {
+            uint8_t mid = (lo + hi) / 2;
+            if (this->calibValues[mid].clear > value.clear)
+                lo = mid;
+            else
+                hi = mid;
         }
     }
 
-    temp_red   *= this->calibCoef[calibIdx][0];
-    temp_green *= this->calibCoef[calibIdx][1];
-    temp_blue  *= this->calibCoef[calibIdx][2];
-    temp_clear *= this->calibCoef[calibIdx][3];
-
-    red   = (float)temp_red   / (float)(this->calibValues[0].red) * 255.0;
-    green = (float)temp_green / (float)(this->calibValues[0].green) * 255.0;
-    blue  = (float)temp_blue  / (float)(this->calibValues[0].blue) * 255.0;
+    const uint16_t raw[3] = {value.red, value.green, value.blue};
+    int16_t *out[3] = {&red, &green, &blue};
+    const CalibScale_t &a = this->calibScale[lo];
+    const CalibScale_t &b = this->calibScale[hi];
+    if (lo == hi) {
+        for (uint8_t ch = 0; ch < 3; ch++) {
+            uint32_t t = ((uint32_t)raw[ch] * a.mul[ch]) >> a.shift[ch];
+            *out[ch] = (t > 255) ? 255 : t;
+        }
+        return;
+    }
 
-    if (red > 255) red = 255;
-    if (green > 255) green = 255;
-    if (blue > 255) blue = 255;
+    /* Weights of rows, (w >> shift) in Q15. The smaller one is computed
+       directly to keep its relative precision, the other one is the rest
+       of 1, so a sample at a row is scaled by this row only */
+    uint16_t dA = value.clear - this->calibValues[hi].clear;
+    uint16_t dB = this->calibValues[lo].clear - value.clear;
+    uint32_t one = 1UL << (a.spanShift + 15);
+    uint32_t wA, wB;
+    if (dA < dB) {
+        wA = (uint32_t)dA * a.spanMul;
+        wB = one - wA;
+    } else {
+        wB = (uint32_t)dB * a.spanMul;
+        wA = one - wB;
+    }
+    int8_t shiftA = a.spanShift + 15, shiftB = a.spanShift + 15;
+    uint16_t mA = normalize16(wA, shiftA);
+    uint16_t mB = normalize16(wB, shiftB);
 
-    if (red < 0) red = 0;
-    if (green < 0) green = 0;
-    if (blue < 0) blue = 0;
+    for (uint8_t ch = 0; ch < 3; ch++) {
+        /* Interpolated scale as sum of weighted row scales, halved so the
+           sum fits into 32 bits */
+        int8_t sA = shiftA + a.shift[ch] - 1;
+        int8_t sB = shiftB + b.shift[ch] - 1;
+        uint32_t pA = ((uint32_t)mA * a.mul[ch]) >> 1;
+        uint32_t pB = ((uint32_t)mB * b.mul[ch]) >> 1;
+        if (sA > sB) {
+            pA = (sA - sB < 32) ? pA >> (sA - sB) : 0;
+            sA = sB;
+        } else {
+            pB = (sB - sA < 32) ? pB >> (sB - sA) : 0;
+        }
+        uint16_t scale = normalize16(pA + pB, sA);
+        uint32_t t = (uint32_t)raw[ch] * scale;
+        if (sA < 0)
+            t = t ? 0xFFFF : 0;
+        else
+            t = (sA < 32) ? t >> sA : 0;
+        *out[ch] = (t > 255) ? 255 : t;
+    }
 }
 
 /******************************************************************************/
 /*!
     @brief    Enables interrupts on RGBC limit values
+    @note     Nothing is written if ENABLE register can't be read, see
+              getLastError()
  */
 /******************************************************************************/
 void Geegrow_TCS34725::enableIRQ() {
-    uint8_t t = this->I2C_read_8(RN_ENABLE);
-    this->I2C_write_8(RN_ENABLE, t | RN_ENABLE_AIEN);
+    uint8_t t;
+    if (this->readReg(RN_ENABLE, t) != TCS34725_OK)
+        return;
+    this->writeReg(RN_ENABLE, t | RN_ENABLE_AIEN);
 }
 
 /******************************************************************************/
 /*!
     @brief    Disables interrupts on RGBC limit values
+    @note     Nothing is written if ENABLE register can't be read, see
+              getLastError()
  */
 /******************************************************************************/
 void Geegrow_TCS34725::disableIRQ() {
-    uint8_t t = this->I2C_read_8(RN_ENABLE);
-    this->I2C_write_8(RN_ENABLE, t & ~RN_ENABLE_AIEN);
+    uint8_t t;
+    if (this->readReg(RN_ENABLE, t) != TCS34725_OK)
+        return;
+    this->writeReg(RN_ENABLE, t & ~RN_ENABLE_AIEN);
 }
 
 /******************************************************************************/
@@ -139,65 +392,495 @@ void Geegrow_TCS34725::disableIRQ() {
  */
 /******************************************************************************/
 void Geegrow_TCS34725::clearIRQ() {
-    Wire.beginTransmission(this->i2c_addr);
-    Wire.write(RN_COMMAND_CMD | RN_COMMAND_TYPE_SF | RN_COMMAND_ADDRSF_CLR_IRQ);
-    Wire.endTransmission();
+    uint8_t cmd = RN_COMMAND_CMD | RN_COMMAND_TYPE_SF | RN_COMMAND_ADDRSF_CLR_IRQ;
+    this->transfer(&cmd, 1, nullptr, 0);
 }
 
 /******************************************************************************/
 /*!
     @brief    Sets values of IRQ limits
-    @param    high    Higher limit
-    @param    low     Lower limit
+    @param    high    Higher limit of clear channel
+    @param    low     Lower limit of clear channel
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::setLimitsIRQ(uint16_t high, uint16_t low) {
+    const uint8_t limits[4] = {
+        (uint8_t)(low & 0xFF), (uint8_t)(low >> 8),
+        (uint8_t)(high & 0xFF), (uint8_t)(high >> 8)
+    };
+    this->writeRegs(RN_AILTL, limits, sizeof(limits));
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets number of consequent out-of-range values to trigger IRQ
+    @param    persistence     One of RN_PERS_CONSEQ_VAL_* values
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::setPersistence(uint8_t persistence) {
+    this->writeReg(RN_PERS, persistence & 0x0F);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Starts interrupt-driven sampling
+    @param    buffer          Reference to buffer for collected samples, e.g.
+                              Geegrow_TCS34725_StaticSampleBuffer<8>
+    @param    persistence     RN_PERS_CONSEQ_VAL_0 to get IRQ on every
+                              integration cycle, other values to get IRQ only
+                              on values outside of limits set by setLimitsIRQ
+    @note     INT pin of device must be attached to an interrupt handler,
+              which calls onInterrupt(). Samples are collected by processIRQ()
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::beginInterruptMode(Geegrow_TCS34725_SampleBuffer &buffer, uint8_t persistence) {
+    this->setPersistence(persistence);
+    this->irqBuffer = &buffer;
+    this->irqBuffer->clear();
+    this->irqOverflow = 0;
+    this->irqMissed = 0;
+    this->irqPending = false;
+    this->clearIRQ();
+    this->enableIRQ();
+}
+
+/******************************************************************************/
+/*!
+    @brief    Stops interrupt-driven sampling
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::endInterruptMode() {
+    this->disableIRQ();
+    this->clearIRQ();
+    this->irqPending = false;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Starts interrupt-driven sampling of scene changes only
+    @param    buffer          Reference to buffer for collected samples
+    @param    band            Allowed deviation of raw clear value from the
+                              last accepted sample
+    @param    persistence     Number of consequent values out of band to
+                              trigger IRQ, one of RN_PERS_CONSEQ_VAL_1..60
+    @note     Limits follow every accepted sample, so IRQ comes only when
+              scene changes. The first cycle always triggers IRQ to set the
+              initial limits. Previous limits, persistence and interrupt mode
+              are restored by disableChangeDetection()
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::enableChangeDetection(Geegrow_TCS34725_SampleBuffer &buffer, uint16_t band, uint8_t persistence) {
+    if (persistence == RN_PERS_CONSEQ_VAL_0)
+        persistence = RN_PERS_CONSEQ_VAL_1;
+    if (!this->changeActive) {
+        /* Registers are cached, so saving costs no bus traffic normally */
+        uint8_t enable = 0;
+        for (uint8_t i = 0; i < 4; i++)
+            this->readReg(RN_AILTL + i, this->changeSavedLimits[i]);
+        this->readReg(RN_PERS, this->changeSavedPers);
+        this->readReg(RN_ENABLE, enable);
+        this->changeSavedIrq = enable & RN_ENABLE_AIEN;
+        this->changeSavedBuffer = this->irqBuffer;
+    }
+    this->changeBand = band;
+    this->changeActive = true;
+    this->changeCentred = false;
+    /* Empty range, any value is out of it */
+    this->setLimitsIRQ(0, 0xFFFF);
+    this->beginInterruptMode(buffer, persistence);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Stops change detection
+    @note     Limits and persistence set before enableChangeDetection() are
+              restored. Interrupt mode running before it goes on with its own
+              buffer, otherwise interrupts are disabled
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::disableChangeDetection() {
+    if (!this->changeActive)
+        return;
+    this->changeActive = false;
+    this->writeRegs(RN_AILTL, this->changeSavedLimits, sizeof(this->changeSavedLimits));
+    this->setPersistence(this->changeSavedPers);
+    if (!this->changeSavedIrq) {
+        this->endInterruptMode();
+        return;
+    }
+    this->irqBuffer = this->changeSavedBuffer;
+    this->clearIRQ();
+    this->irqPending = false;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Moves IRQ limits around clear value of accepted sample
+    @param    clear   Raw clear value
+    @note     Limits are kept while value stays within quarter of band from
+              their centre, so polling doesn't cause bus traffic on small drift
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::updateChangeLimits(uint16_t clear) {
+    uint16_t drift = (clear > this->changeCentre) ? clear - this->changeCentre : this->changeCentre - clear;
+    if (this->changeCentred && drift <= this->changeBand / 4)
+        return;
+    uint16_t low = (clear > this->changeBand) ? clear - this->changeBand : 0;
+    uint16_t high = (0xFFFF - clear > this->changeBand) ? clear + this->changeBand : 0xFFFF;
+    this->setLimitsIRQ(high, low);
+    this->changeCentre = clear;
+    this->changeCentred = true;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Marks completed integration cycle, must be called from ISR of INT pin
+    @note     No bus transactions are made here, it is safe for interrupt context
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::onInterrupt() {
+    this->irqTimestamp = micros();
+    this->irqPending = true;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Moves flagged sample from device to sample buffer and clears IRQ
+    @return   Number of samples stored in buffer
+    @note     Call it from main loop as often as possible. Cycles completed
+              between IRQ and this call are overwritten by device and counted
+              as missed
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725::processIRQ() {
+    if (!this->irqPending || !this->irqBuffer)
+        return 0;
+    noInterrupts();
+    uint32_t stamp = this->irqTimestamp;
+    this->irqPending = false;
+    interrupts();
+
+    RGBC_value_t value;
+    uint8_t status = this->readRGBC(value);
+    this->clearIRQ();
+    if (status != TCS34725_OK) {
+        this->irqMissed++;
+        return 0;
+    }
+    if (this->currentCyclePeriod)
+        this->irqMissed += (micros() - stamp) / this->currentCyclePeriod;
+    /* Clipped sample of auto-ranging is not stored */
+    if (!this->processSample(value))
+        return 0;
+    if (!this->irqBuffer->push(value)) {
+        this->irqOverflow++;
+        return 0;
+    }
+    return 1;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Takes the oldest sample collected in interrupt mode
+    @param    value   Reference to structure for RGBC values
+    @return   True if value was updated
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725::readSample(RGBC_value_t &value) {
+    return this->irqBuffer && this->irqBuffer->pop(value);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get number of samples collected in interrupt mode
+    @return   Number of samples in buffer
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725::samplesAvailable() {
+    return this->irqBuffer ? this->irqBuffer->available() : 0;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get counters of samples lost in interrupt mode
+    @param    overflow    Reference to number of samples lost on full buffer
+    @param    missed      Reference to number of cycles overwritten by device
+                          before they were read
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::getDroppedSamples(uint16_t &overflow, uint16_t &missed) {
+    overflow = this->irqOverflow;
+    missed = this->irqMissed;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Enables automatic choice of gain and integration time
+    @param    enable  True to enable auto-ranging
+    @note     Current integration time and gain become the reference: samples
+              are normalized to this configuration, so calibration stays
+              valid, and integration time is never made longer than it
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::setAutoRange(bool enable) {
+    if (enable && !this->autoRange) {
+        this->refATIME = this->currentATIME;
+        this->refGain = this->currentGain;
+        this->updateNormalization();
+    }
+    this->autoRange = enable;
+    this->updateColorConfig();
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets filter applied to every sample before conversion
+    @param    filter  Pointer to filter, nullptr to pass samples unchanged
+    @note     Filter is owned by caller, its mode is set by setMode()
  */
 /******************************************************************************/
-void Geegrow_TCS34725::setLimitsIRQ(int16_t high, int16_t low) {
-    this->I2C_write_8(RN_AIHTH, high >> 8);
-    this->I2C_write_8(RN_AIHTL, high & 0xFF);
-    this->I2C_write_8(RN_AILTH, low >> 8);
-    this->I2C_write_8(RN_AILTL, low & 0xFF);
+void Geegrow_TCS34725::setFilter(Geegrow_TCS34725_Filter *filter) {
+    this->filter = filter;
+    if (filter)
+        filter->reset();
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets converter to lux, CCT, XYZ, L*a*b* and HSV
+    @param    color   Pointer to converter, nullptr to detach
+    @note     Converter is owned by caller, driver keeps it configured for
+              current gain and integration time
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::setColor(Geegrow_TCS34725_Color *color) {
+    this->color = color;
+    this->updateColorConfig();
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets recorder of raw samples and configuration changes
+    @param    writer  Pointer to started trace writer, nullptr to stop
+    @note     Current configuration is recorded at once. Call poll() of
+              writer from main loop to send recorded data
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::setTraceWriter(Geegrow_TCS34725_TraceWriter *writer) {
+    this->traceWriter = writer;
+    if (writer)
+        writer->recordConfig(this->currentATIME, this->currentGain, micros());
+}
+
+/******************************************************************************/
+/*!
+    @brief    Processes sample as if it was read from device
+    @param    value   Reference to structure with raw RGBC values, replaced
+                      by processed values
+    @return   False if sample was dropped as clipped by auto-ranging
+    @note     Used to replay recorded traces, see Geegrow_TCS34725_TraceReader
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725::injectSample(RGBC_value_t &value) {
+    return this->processSample(value);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Switches device to periodic mode with wait state between cycles
+    @param    period  Target sample period in microseconds
+    @return   Achieved sample period in microseconds
+    @note     Integration time is kept if it fits into period, otherwise the
+              longest integration time that fits is chosen with 2.4 ms step.
+              Wait state is disabled if period is not longer than integration
+              time
+ */
+/******************************************************************************/
+uint32_t Geegrow_TCS34725::setSamplePeriod(uint32_t period) {
+    if (this->getIntegrationTime_us() > period)
+        this->setIntegrationTime(TCS34725_atimeFor_us(period));
+
+    uint32_t wait = 0;
+    if (period > this->getIntegrationTime_us())
+        wait = period - this->getIntegrationTime_us();
+    /* Wait step is 2.4 ms, or 28.8 ms with WLONG, up to 256 steps */
+    uint32_t cycles = (wait + TCS34725_CYCLE_US / 2) / TCS34725_CYCLE_US;
+    if (cycles <= 256) {
+        this->setWaitTime(cycles, false);
+    } else {
+        cycles = (wait + TCS34725_CYCLE_US * 6) / (TCS34725_CYCLE_US * 12);
+        this->setWaitTime((cycles > 256) ? 256 : cycles, true);
+    }
+    this->startConversion();
+    return this->getSamplePeriod();
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get achieved sample period
+    @return   Duration of integration and wait states in microseconds
+ */
+/******************************************************************************/
+uint32_t Geegrow_TCS34725::getSamplePeriod() {
+    return this->getIntegrationTime_us() + this->getWaitTime_us();
+}
+
+/******************************************************************************/
+/*!
+    @brief    Estimates average supply current of device in current mode
+    @return   Current in uA, based on typical values from datasheet
+ */
+/******************************************************************************/
+uint16_t Geegrow_TCS34725::getAverageCurrent() {
+    uint32_t integration = this->getIntegrationTime_us();
+    uint32_t wait = this->getWaitTime_us();
+    /* Scale down to tenths of ms to keep products in 32 bits */
+    integration /= 100;
+    wait /= 100;
+    return (ACTIVE_CURRENT_UA * integration + WAIT_CURRENT_UA * wait) / (integration + wait);
 }
 
 /******************************************************************************/
 /*!
     @brief    Realize auto-calibration of the sensor
+    @return   True if table is recorded, false without table storage or on
+              bus error
+    @note     Blocking wrapper of beginCalibration(). Samples are recorded
+              into table storage itself, so the previous table is dropped
+              when calibration starts. Storage is given by
+              setCalibrationStorage()
  */
 /******************************************************************************/
-void Geegrow_TCS34725::calibrate() {
+bool Geegrow_TCS34725::calibrate() {
+    if (this->calibCapacity < MIN_CALIB_TABLE_SIZE) {
+        Serial.println("Calibration failed: no table storage");
+        return false;
+    }
     Serial.println("Calibration starts. Bring a white sample to the sensor in 5 sec");
     delay(5000);
     Serial.println("Calibrating..");
-    int16_t red, green, blue, clear;
     /* Number of calibration samples */
-    uint16_t temp = CALIBRATION_TIME / this->currentIntegrationTime;
-    this->calibTableSize = (temp > MAX_CALIB_TABLE_SIZE) ? MAX_CALIB_TABLE_SIZE : temp;
-    /* Calibration table */
-    this->calibValues = new RGBC_value_t[this->calibTableSize];
-    /* Delay between calibration samples */
-    uint16_t delayDelta = CALIBRATION_TIME / this->calibTableSize - this->currentIntegrationTime;
-
-    /* Record samples */
-    for (uint8_t i = 0; i < this->calibTableSize; i++) {
-        this->getRawData(red, green, blue, clear);
-        this->calibValues[i].red = red;
-        this->calibValues[i].green = green;
-        this->calibValues[i].blue = blue;
-        this->calibValues[i].clear = clear;
-        delay(delayDelta);
-    }
-    /* Range recorded samples from MAX to MIN value of clear component */
-    Tools::bubble_sort(this->calibValues, this->calibTableSize);
-    /* Calculate scaling coefs */
-    /* Row 1 without any corrections */
-    for (uint8_t i = 0; i < 4; i++)
-        this->calibCoef[0][i] = 1.0;
-    /* Calculate other rows */
-    for (uint8_t i = 1; i < this->calibTableSize; i++) {
-        this->calibCoef[i][0] = (float)this->calibValues[0].red / (float)this->calibValues[i].red;
-        this->calibCoef[i][1] = (float)this->calibValues[0].green / (float)this->calibValues[i].green;
-        this->calibCoef[i][2] = (float)this->calibValues[0].blue / (float)this->calibValues[i].blue;
-        this->calibCoef[i][3] = (float)this->calibValues[0].clear / (float)this->calibValues[i].clear;
+    uint32_t temp = CALIBRATION_TIME * 1000UL / this->getIntegrationTime_us();
+    uint8_t samples = (temp > this->calibCapacity) ? this->calibCapacity : temp;
+    this->calibTableSize = 0;
+    this->beginCalibration(this->calibValues, samples, CALIBRATION_TIME / samples);
+
+    RGBC_value_t value;
+    while (this->isCalibrating()) {
+        if (this->getRawData(value) != TCS34725_OK) {
+            Serial.println("Calibration failed: sensor is not responding");
+            this->cancelCalibration();
+            return false;
+        }
     }
+    return true;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Starts calibration without blocking
+    @param    staging     Pointer to array for recorded samples, must stay
+                          valid until calibration is completed or cancelled
+    @param    samples     Number of samples to record, size of staging
+                          array, MIN_CALIB_TABLE_SIZE at least
+    @param    interval    Minimal time between recorded samples, ms
+    @return   True if calibration is started, false without table storage
+              or staging array
+    @note     Samples are taken from the normal acquisition path (readIfReady,
+              getRawData, processIRQ) while a white sample is in front of the
+              sensor. Previous table keeps converting samples until all
+              samples are recorded, then it is replaced at once
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725::beginCalibration(RGBC_value_t *staging, uint8_t samples, uint16_t interval) {
+    if (samples > this->calibCapacity)
+        samples = this->calibCapacity;
+    this->calibStaging = staging;
+    this->calibCount = 0;
+    this->calibTarget = samples;
+    this->calibInterval = interval;
+    this->calibLastSample = millis() - interval;
+    this->calibActive = staging && samples >= MIN_CALIB_TABLE_SIZE;
+    return this->calibActive;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Stops calibration, previous table is kept
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::cancelCalibration() {
+    this->calibActive = false;
+    this->calibStaging = nullptr;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Checks if calibration started by beginCalibration() is running
+    @return   True if calibration is running
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725::isCalibrating() {
+    return this->calibActive;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets functions reporting calibration state
+    @param    progress    Called after every recorded sample, may be nullptr
+    @param    complete    Called when all samples are recorded, may be nullptr
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::setCalibrationCallbacks(CalibrationCallback_t progress, CalibrationCallback_t complete) {
+    this->calibProgressCb = progress;
+    this->calibCompleteCb = complete;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Inserts white reference sample into calibration table
+    @param    value   Reference to structure with RGBC values
+    @return   False if there is no table storage
+    @note     Table is kept sorted from MAX to MIN value of clear component,
+              only scales of affected rows are recalculated. If table is full,
+              the row closest by clear value is replaced, so the table may be
+              refined online
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725::addCalibrationSample(const RGBC_value_t &value) {
+    if (this->calibCapacity == 0)
+        return false;
+    uint8_t size = this->calibTableSize;
+    if (size == this->calibCapacity) {
+        uint8_t nearest = 0;
+        uint16_t best = 0xFFFF;
+        for (uint8_t i = 0; i < size; i++) {
+            uint16_t c = this->calibValues[i].clear;
+            uint16_t d = (c > value.clear) ? c - value.clear : value.clear - c;
+            if (d < best) {
+                best = d;
+                nearest = i;
+            }
+        }
+        size--;
+        memmove(&this->calibValues[nearest], &this->calibValues[nearest + 1], (size - nearest) * sizeof(RGBC_value_t));
+        memmove(&this->calibScale[nearest], &this->calibScale[nearest + 1], (size - nearest) * sizeof(CalibScale_t));
+        this->calibTableSize = size;
+        if (nearest > 0)
+            this->calcRow(nearest - 1);
+    }
+
+    uint8_t pos = size;
+    while (pos > 0 && this->calibValues[pos - 1].clear < value.clear)
+        pos--;
+    memmove(&this->calibValues[pos + 1], &this->calibValues[pos], (size - pos) * sizeof(RGBC_value_t));
+    memmove(&this->calibScale[pos + 1], &this->calibScale[pos], (size - pos) * sizeof(CalibScale_t));
+    this->calibValues[pos] = value;
+    this->calibTableSize = size + 1;
+    this->calcRow(pos);
+    if (pos > 0)
+        this->calcRow(pos - 1);
+    return true;
 }
 
 /******************************************************************************/
@@ -205,67 +888,182 @@ void Geegrow_TCS34725::calibrate() {
     @brief    Upload user's calibration table instead of auto-calibration
     @param    array   Pointer to array of user's RGBC values for calibration
     @param    size    Number of samples in array
+    @return   False if array is too short or there is no table storage
+    @note     Values are copied, user's array is left unchanged. Rows beyond
+              capacity of table storage are dropped
  */
 /******************************************************************************/
-void Geegrow_TCS34725::calibrateManual(RGBC_value_t* array, uint8_t size) {
-    if (!array || size < 2)
-        return;
-    if (size > MAX_CALIB_TABLE_SIZE)
-        size = MAX_CALIB_TABLE_SIZE;
-    this->calibValues = array;
+bool Geegrow_TCS34725::calibrateManual(const RGBC_value_t* array, uint8_t size) {
+    if (!array || size < MIN_CALIB_TABLE_SIZE || this->calibCapacity < MIN_CALIB_TABLE_SIZE)
+        return false;
+    this->calibActive = false;
+    this->loadTable(array, size);
+    return true;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Replaces calibration table with given samples
+    @param    array   Pointer to array of RGBC values, may be the table itself
+    @param    size    Number of samples in array
+    @note     Rows are sorted in place by insertion, rows with equal clear
+              value keep their order
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::loadTable(const RGBC_value_t *array, uint8_t size) {
+    if (size > this->calibCapacity)
+        size = this->calibCapacity;
+    if (size && array != this->calibValues)
+        memmove(this->calibValues, array, size * sizeof(RGBC_value_t));
+    for (uint8_t i = 1; i < size; i++) {
+        RGBC_value_t value = this->calibValues[i];
+        uint8_t pos = i;
+        while (pos > 0 && this->calibValues[pos - 1].clear < value.clear) {
+            this->calibValues[pos] = this->calibValues[pos - 1];
+            pos--;
+        }
+        this->calibValues[pos] = value;
+    }
     this->calibTableSize = size;
-    /* Range recorded samples from MAX to MIN value of clear component */
-    Tools::bubble_sort(this->calibValues, this->calibTableSize);
-    /* Calculate scaling coefs */
-    /* Row 1 without any corrections */
-    for (uint8_t i = 0; i < 4; i++)
-        this->calibCoef[0][i] = 1.0;
-    /* Calculate other rows */
-    for (uint8_t i = 1; i < this->calibTableSize; i++) {
-        this->calibCoef[i][0] = (float)this->calibValues[0].red / (float)this->calibValues[i].red;
-        this->calibCoef[i][1] = (float)this->calibValues[0].green / (float)this->calibValues[i].green;
-        this->calibCoef[i][2] = (float)this->calibValues[0].blue / (float)this->calibValues[i].blue;
-        this->calibCoef[i][3] = (float)this->calibValues[0].clear / (float)this->calibValues[i].clear;
+    this->calcCoefficients();
+}
+
+/******************************************************************************/
+/*!
+    @brief    Precomputes fixed-point scales of calibration rows
+    @note     Row i maps its own RGB values to 255, so the scale of channel is
+              255 / calibValues[i], stored as 16-bit mantissa and shift.
+              Reciprocal of clear span to the next row is stored the same way
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::calcCoefficients() {
+    for (uint8_t i = 0; i < this->calibTableSize; i++)
+        this->calcRow(i);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Precomputes fixed-point scales of one calibration row
+    @param    row     Index of row
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::calcRow(uint8_t row) {
+    CalibScale_t &scale = this->calibScale[row];
+    const uint16_t ref[3] = {
+        this->calibValues[row].red,
+        this->calibValues[row].green,
+        this->calibValues[row].blue
+    };
+    for (uint8_t ch = 0; ch < 3; ch++) {
+        calcReciprocal(255, 24, ref[ch], scale.mul[ch], scale.shift[ch]);
+        /* Rounded down mantissa would map reference itself to 254 */
+        if ((((uint32_t)ref[ch] * scale.mul[ch]) >> scale.shift[ch]) < 255 && scale.mul[ch] < 0xFFFF)
+            scale.mul[ch]++;
+    }
+
+    scale.spanMul = 0;
+    scale.spanShift = 0;
+    if (row + 1 < this->calibTableSize) {
+        uint16_t span = this->calibValues[row].clear - this->calibValues[row + 1].clear;
+        if (span)
+            calcReciprocal(1UL << 15, 16, span, scale.spanMul, scale.spanShift);
     }
 }
 
+/******************************************************************************/
+/*!
+    @brief    Represents num / den as 16-bit mantissa and shift
+    @param    num         Numerator, (num << maxShift) must fit into 32 bits
+    @param    maxShift    Maximal shift to try
+    @param    den         Denominator
+    @param    mul         Reference to mantissa
+    @param    shift       Reference to shift
+    @note     Largest shift keeping mantissa in 16 bits gives best precision.
+              Zero denominator gives a mantissa which saturates any value
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::calcReciprocal(uint32_t num, uint8_t maxShift, uint16_t den, uint16_t &mul, uint8_t &shift) {
+    if (den == 0) {
+        mul = 0xFFFF;
+        shift = 0;
+        return;
+    }
+    shift = maxShift;
+    uint32_t m = ((num << shift) + den / 2) / den;
+    while (m > 0xFFFF && shift > 0) {
+        shift--;
+        m = ((num << shift) + den / 2) / den;
+    }
+    mul = (m > 0xFFFF) ? 0xFFFF : m;
+}
+
 /******************************************************************************/
 /*!
     @brief    Get values, recorded during calibration
     @param    size    Reference to size of array of calibration values
-    @return   Pointer to array of calibration values
+    @return   Pointer to array of calibration values, nullptr without
+              table storage
  */
 /******************************************************************************/
-RGBC_value_t* Geegrow_TCS34725::getCalibrationValues(uint8_t &size) {
+const RGBC_value_t* Geegrow_TCS34725::getCalibrationValues(uint8_t &size) {
     size = this->calibTableSize;
     return this->calibValues;
 }
 
+/******************************************************************************/
+/*!
+    @brief    Get maximal number of rows of calibration table
+    @return   Number of rows of table storage
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725::getCalibrationCapacity() {
+    return this->calibCapacity;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets storage of calibration table owned by caller
+    @param    values      Pointer to array for rows of table
+    @param    scales      Pointer to array for precomputed scales of rows
+    @param    capacity    Number of elements in both arrays,
+                          MIN_CALIB_TABLE_SIZE at least
+    @return   True if storage is accepted
+    @note     Driver has no table of its own, so RAM follows rows actually
+              used. Calibration functions fail until storage is given. Table
+              in previous storage is copied, rows beyond capacity are
+              dropped. Storage must outlive driver.
+              Geegrow_TCS34725_CalibStorage gives both arrays of the same size
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725::setCalibrationStorage(RGBC_value_t *values, CalibScale_t *scales, uint8_t capacity) {
+    if (!values || !scales || capacity < MIN_CALIB_TABLE_SIZE)
+        return false;
+    const RGBC_value_t *previous = this->calibValues;
+    uint8_t size = this->calibTableSize;
+    this->calibValues = values;
+    this->calibScale = scales;
+    this->calibCapacity = capacity;
+    this->loadTable(previous, size);
+    return true;
+}
+
 /******************************************************************************/
 /*!
     @brief    Sets value of integration time
-    @param    time    Value of integration time
+    @param    time    Value of ATIME register, any of 256 values is allowed:
+                      integration time is 2.4 ms * (256 - time). Use
+                      TCS34725_atimeFor_us() to get it from time
  */
 /******************************************************************************/
 void Geegrow_TCS34725::setIntegrationTime(uint8_t time) {
-    this->I2C_write_8(RN_ATIME, time);
-    switch (time) {
-        case RN_ATIME_INTEG_TIME_2_4:
-            this->currentIntegrationTime = 3;
-            break;
-        case RN_ATIME_INTEG_TIME_24:
-            this->currentIntegrationTime = 24;
-            break;
-        case RN_ATIME_INTEG_TIME_101:
-            this->currentIntegrationTime = 101;
-            break;
-        case RN_ATIME_INTEG_TIME_154:
-            this->currentIntegrationTime = 154;
-            break;
-        case RN_ATIME_INTEG_TIME_700:
-            this->currentIntegrationTime = 700;
-            break;
-    }
+    this->writeReg(RN_ATIME, time);
+    this->currentATIME = time;
+    this->currentCyclePeriod = this->getSamplePeriod();
+    if (this->autoRange)
+        this->updateNormalization();
+    this->updateColorConfig();
+    if (this->traceWriter)
+        this->traceWriter->recordConfig(this->currentATIME, this->currentGain, micros());
 }
 
 /******************************************************************************/
@@ -275,83 +1073,494 @@ void Geegrow_TCS34725::setIntegrationTime(uint8_t time) {
  */
 /******************************************************************************/
 void Geegrow_TCS34725::setGain(uint8_t gain) {
-    this->I2C_write_8(RN_CONTROL, gain);
+    this->writeReg(RN_CONTROL, gain);
     this->currentGain = gain;
+    if (this->autoRange)
+        this->updateNormalization();
+    this->updateColorConfig();
+    if (this->traceWriter)
+        this->traceWriter->recordConfig(this->currentATIME, this->currentGain, micros());
 }
 
 /******************************************************************************/
 /*!
-    @brief    Write 8 bit value to device register
+    @brief    Post-processing of every sample read from device
+    @param    value   Reference to structure with raw RGBC values
+    @return   False if sample is dropped
+    @note     With auto-ranging a sample with clipped clear value only switches
+              range. Its channels are not proportional to light any more, so
+              it is not normalized, filtered or used for calibration
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725::processSample(RGBC_value_t &value) {
+    if (this->traceWriter)
+        this->traceWriter->recordSample(value, micros());
+    /* Device compares raw clear value with limits */
+    if (this->changeActive)
+        this->updateChangeLimits(value.clear);
+    if (this->autoRange) {
+        uint16_t clear = value.clear;
+        if (clear >= TCS34725_saturation(TCS34725_cycles(this->currentATIME))) {
+            this->updateRange(clear);
+            return false;
+        }
+        uint16_t *ch[4] = {&value.red, &value.green, &value.blue, &value.clear};
+        for (uint8_t i = 0; i < 4; i++) {
+            uint32_t t = ((uint32_t)*ch[i] * this->normMul) >> this->normShift;
+            *ch[i] = (t > 0xFFFF) ? 0xFFFF : t;
+        }
+        this->updateRange(clear);
+    }
+    if (this->filter)
+        this->filter->apply(value);
+    if (this->calibActive && (uint32_t)(millis() - this->calibLastSample) >= this->calibInterval) {
+        this->calibLastSample = millis();
+        this->calibStaging[this->calibCount++] = value;
+        if (this->calibProgressCb)
+            this->calibProgressCb(this->calibCount, this->calibTarget);
+        if (this->calibCount >= this->calibTarget) {
+            this->calibActive = false;
+            this->loadTable(this->calibStaging, this->calibCount);
+            this->calibStaging = nullptr;
+            if (this->calibCompleteCb)
+                this->calibCompleteCb(this->calibTableSize, this->calibTarget);
+        }
+    }
+    return true;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Chooses gain and integration time for the next samples
+    @param    clear   Raw clear value of the last sample
+    @note     The most sensitive setting predicted to keep clear value below
+              AUTO_RANGE_TARGET is chosen. Clipped sample switches to the least
+              sensitive setting, so range converges in 2 samples at most
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::updateRange(uint16_t clear) {
+    uint16_t cycles = TCS34725_cycles(this->currentATIME);
+    uint32_t saturation = TCS34725_saturation(cycles);
+    if (clear >= saturation * AUTO_RANGE_LOW / 100 && clear <= saturation * AUTO_RANGE_HIGH / 100)
+        return;
+
+    /* Gain and cycles from the most to the least sensitive */
+    const uint16_t refCycles = TCS34725_cycles(this->refATIME);
+    const uint16_t minCycles = (refCycles > 64) ? 64 : refCycles;
+    const uint8_t gains[] = {
+        RN_CONTROL_GAIN_60X,
+        RN_CONTROL_GAIN_16X,
+        RN_CONTROL_GAIN_4X,
+        RN_CONTROL_GAIN_1X,
+        RN_CONTROL_GAIN_1X
+    };
+    const uint8_t count = sizeof(gains);
+    uint8_t newGain = gains[count - 1];
+    uint16_t newCycles = minCycles;
+    if (clear < saturation) {
+        uint16_t sensitivity = TCS34725_sensitivity(this->currentGain, cycles);
+        for (uint8_t i = 0; i < count; i++) {
+            uint16_t c = (i == count - 1) ? minCycles : refCycles;
+            uint32_t predicted = (uint32_t)clear * TCS34725_sensitivity(gains[i], c) / sensitivity;
+            uint32_t limit = TCS34725_saturation(c);
+            if (predicted <= limit * AUTO_RANGE_TARGET / 100) {
+                newGain = gains[i];
+                newCycles = c;
+                break;
+            }
+        }
+    }
+
+    if (newGain == this->currentGain && newCycles == cycles)
+        return;
+    if (newGain != this->currentGain)
+        this->setGain(newGain);
+    /* Setters also update normalization */
+    if (newCycles != cycles)
+        this->setIntegrationTime(TCS34725_atime(newCycles));
+    /* Drop cycle integrated partly with previous settings */
+    this->startConversion();
+}
+
+/******************************************************************************/
+/*!
+    @brief    Precomputes factor from current to reference configuration
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::updateNormalization() {
+    calcReciprocal(
+        TCS34725_sensitivity(this->refGain, TCS34725_cycles(this->refATIME)), 17,
+        TCS34725_sensitivity(this->currentGain, TCS34725_cycles(this->currentATIME)),
+        this->normMul, this->normShift
+    );
+}
+
+/******************************************************************************/
+/*!
+    @brief    Passes configuration samples are scaled to, to color converter
+    @note     With auto-ranging samples are normalised to reference settings
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::updateColorConfig() {
+    if (!this->color)
+        return;
+    if (this->autoRange)
+        this->color->setConfig(this->refATIME, this->refGain);
+    else
+        this->color->setConfig(this->currentATIME, this->currentGain);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets duration of wait state between integration cycles
+    @param    cycles      Number of 2.4 ms wait steps (1..256), 0 disables wait
+    @param    waitLong    Multiply wait steps by 12
+    @note     Nothing is changed if ENABLE register can't be read
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::setWaitTime(uint16_t cycles, bool waitLong) {
+    uint8_t t;
+    if (this->readReg(RN_ENABLE, t) != TCS34725_OK)
+        return;
+    if (cycles == 0) {
+        this->writeReg(RN_ENABLE, t & ~RN_ENABLE_WEN);
+    } else {
+        /* 256 steps are written as 0 */
+        this->writeReg(RN_WTIME, (uint8_t)(256 - cycles));
+        this->writeReg(RN_CONFIG, waitLong ? RN_CONFIG_WLONG : 0);
+        this->writeReg(RN_ENABLE, t | RN_ENABLE_WEN);
+    }
+    this->currentWaitCycles = cycles;
+    this->currentWaitLong = waitLong;
+    this->currentCyclePeriod = this->getSamplePeriod();
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get duration of integration state
+    @return   Integration time in microseconds
+ */
+/******************************************************************************/
+uint32_t Geegrow_TCS34725::getIntegrationTime_us() {
+    return TCS34725_integrationTime_us(this->currentATIME);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get duration of wait state
+    @return   Wait time in microseconds, 0 if wait state is disabled
+ */
+/******************************************************************************/
+uint32_t Geegrow_TCS34725::getWaitTime_us() {
+    uint32_t wait = TCS34725_CYCLE_US * this->currentWaitCycles;
+    return this->currentWaitLong ? wait * 12 : wait;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Writes all known configuration registers to device
+    @note     Use it to restore configuration after brown-out of device
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::sync() {
+    uint16_t valid = this->shadowValid;
+    this->shadowValid = 0;
+    /* Contiguous registers are written in bursts, power on goes last */
+    uint8_t reg = RN_ATIME;
+    while (reg < SHADOW_SIZE) {
+        uint8_t len = 0;
+        while (reg + len < SHADOW_SIZE && (valid & (1 << (reg + len))))
+            len++;
+        if (len)
+            this->writeRegs(reg, &this->shadow[reg], len);
+        reg += len + 1;
+    }
+    if (valid & (1 << RN_ENABLE)) {
+        uint8_t t = this->shadow[RN_ENABLE];
+        this->writeReg(RN_ENABLE, t & RN_ENABLE_PON);
+        delay(3);
+        this->writeReg(RN_ENABLE, t);
+        this->conversionStart = micros();
+    }
+}
+
+/******************************************************************************/
+/*!
+    @brief    Reads all configuration registers from device in one transaction
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::refresh() {
+    if (this->I2C_read_block(RN_ENABLE, this->shadow, SHADOW_SIZE) == TCS34725_OK)
+        this->shadowValid = SHADOW_REGS;
+    else
+        this->shadowValid = 0;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Writes register if its value differs from the cached one
     @param    reg     Register to edit
     @param    value   New value
  */
 /******************************************************************************/
-void Geegrow_TCS34725::I2C_write_8(uint8_t reg, uint8_t value) {
-    Wire.beginTransmission(this->i2c_addr);
-    Wire.write(RN_COMMAND_CMD | reg);
-    Wire.write(value & 0xFF);
-    Wire.endTransmission();
+void Geegrow_TCS34725::writeReg(uint8_t reg, uint8_t value) {
+    this->writeRegs(reg, &value, 1);
 }
 
 /******************************************************************************/
 /*!
-    @brief    Read 8 bit value from device register
-    @param    reg     Register to be read
-    @return   8-bit value of register
+    @brief    Writes sequence of registers in one transaction
+    @param    reg     First register to edit
+    @param    values  Pointer to new values
+    @param    len     Number of registers, up to SHADOW_SIZE
+    @note     Registers matching the cache at both ends are not sent
  */
 /******************************************************************************/
-uint8_t Geegrow_TCS34725::I2C_read_8(uint8_t reg) {
-    Wire.beginTransmission(this->i2c_addr);
-    Wire.write(RN_COMMAND_CMD | reg);
-    Wire.endTransmission();
-    Wire.requestFrom(this->i2c_addr, 1);
-    return Wire.read();
+void Geegrow_TCS34725::writeRegs(uint8_t reg, const uint8_t *values, uint8_t len) {
+    while (len && this->isCached(reg, values[0])) {
+        reg++;
+        values++;
+        len--;
+    }
+    while (len && this->isCached(reg + len - 1, values[len - 1]))
+        len--;
+    if (len == 0)
+        return;
+    uint8_t status;
+    if (len == 1)
+        status = this->I2C_write_8(reg, values[0]);
+    else
+        status = this->I2C_write_block(reg, values, len);
+    for (uint8_t i = 0; i < len; i++, reg++) {
+        if (reg < SHADOW_SIZE && (SHADOW_REGS & (1 << reg))) {
+            /* State of device is unknown after failed write */
+            if (status == TCS34725_OK) {
+                this->shadow[reg] = values[i];
+                this->shadowValid |= 1 << reg;
+            } else {
+                this->shadowValid &= ~(1 << reg);
+            }
+        }
+    }
 }
 
 /******************************************************************************/
 /*!
-    @brief    Read 16 bit value from device register
+    @brief    Reads register from cache, or from device if it is not cached
     @param    reg     Register to be read
-    @return   16-bit value of register
+    @param    value   Reference to 8-bit value of register
+    @return   TCS34725_OK or error code, value is not valid on error
  */
 /******************************************************************************/
-uint16_t Geegrow_TCS34725::I2C_read_16(uint8_t reg) {
-    uint16_t x, t;
-    Wire.beginTransmission(this->i2c_addr);
-    Wire.write(RN_COMMAND_CMD | reg);
-    Wire.endTransmission();
-    Wire.requestFrom(this->i2c_addr, 2);
-    t = Wire.read();
-    x = Wire.read();
-    x <<= 8;
-    x |= t;
-    return x;
+uint8_t Geegrow_TCS34725::readReg(uint8_t reg, uint8_t &value) {
+    if (reg < SHADOW_SIZE && (this->shadowValid & (1 << reg))) {
+        value = this->shadow[reg];
+        return TCS34725_OK;
+    }
+    uint8_t status = this->I2C_read_8(reg, value);
+    if (status != TCS34725_OK)
+        return status;
+    if (reg < SHADOW_SIZE && (SHADOW_REGS & (1 << reg))) {
+        this->shadow[reg] = value;
+        this->shadowValid |= 1 << reg;
+    }
+    return TCS34725_OK;
 }
 
 /******************************************************************************/
 /*!
-    @brief    Sort array from MAX to MIN
-    @param    array   Pointer to array of RGBC values for sorting
-    @param    size    Number of samples in array
+    @brief    Checks if register is cached with the same value
+    @param    reg     Register
+    @param    value   Value to compare
+    @return   True if write of value may be skipped
  */
 /******************************************************************************/
-void Tools::bubble_sort(RGBC_value_t *array, uint8_t array_size) {
-    uint8_t i = 0;
-    RGBC_value_t buf;
-    bool swap_cnt = false;
-    if (array_size == 0)
-        return;
-    while (i < array_size) {
-        if (i + 1 != array_size && array[i].clear < array[i + 1].clear) {
-            buf = array[i];
-            array[i] = array[i + 1];
-            array[i + 1] = buf;
-            swap_cnt = true;
-        }
-        i++;
-        if (i == array_size && swap_cnt) {
-            swap_cnt = false;
-            i = 0;
+bool Geegrow_TCS34725::isCached(uint8_t reg, uint8_t value) {
+    return reg < SHADOW_SIZE && (this->shadowValid & (1 << reg)) && this->shadow[reg] == value;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets number of retries of failed bus transactions
+    @param    retries     Number of retries, 0 to report errors at once
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::setRetries(uint8_t retries) {
+    this->retries = retries;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets how long getRawData waits for result after cycle period
+    @param    timeout     Timeout in ms
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::setTimeout(uint16_t timeout) {
+    this->timeout = timeout;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get result of the last bus operation
+    @return   TCS34725_OK or error code
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725::getLastError() {
+    return this->lastError;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get counters of bus activity and errors
+    @param    stats   Reference to structure for counters
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::getStats(TCS34725_Stats_t &stats) {
+    stats = this->stats;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Resets counters of bus activity and errors
+ */
+/******************************************************************************/
+void Geegrow_TCS34725::resetStats() {
+    memset(&this->stats, 0, sizeof(this->stats));
+}
+
+/******************************************************************************/
+/*!
+    @brief    Makes bus transaction with retries and accounting
+    @param    tx      Pointer to bytes to be sent
+    @param    txLen   Number of bytes to be sent
+    @param    rx      Pointer to buffer for received bytes, if any
+    @param    rxLen   Number of bytes to be received, 0 for write only
+    @return   TCS34725_OK or error code
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725::transfer(const uint8_t *tx, uint8_t txLen, uint8_t *rx, uint8_t rxLen) {
+    uint32_t start = micros();
+    uint8_t status;
+    for (uint8_t attempt = 0; ; attempt++) {
+        status = TCS34725_OK;
+        this->stats.transactions++;
+        this->stats.bytes += txLen;
+        uint8_t result = this->bus->write(this->i2c_addr, tx, txLen);
+        if (result == 5) {
+            /* Timeout code of TwoWire in cores with setWireTimeout() */
+            status = TCS34725_ERR_TIMEOUT;
+            this->stats.timeouts++;
+        } else if (result) {
+            status = TCS34725_ERR_NACK;
+            this->stats.nacks++;
+        } else if (rxLen) {
+            this->stats.transactions++;
+            uint8_t received = this->bus->read(this->i2c_addr, rx, rxLen);
+            this->stats.bytes += received;
+            if (received != rxLen) {
+                status = TCS34725_ERR_SHORT_READ;
+                this->stats.shortReads++;
+            }
         }
+        if (status == TCS34725_OK || attempt >= this->retries)
+            break;
+        this->stats.retries++;
     }
-}
\ No newline at end of file
+    this->stats.busTime += micros() - start;
+    this->lastError = status;
+    return status;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Write 8 bit value to device register
+    @param    reg     Register to edit
+    @param    value   New value
+    @return   TCS34725_OK or error code
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725::I2C_write_8(uint8_t reg, uint8_t value) {
+    uint8_t buf[2] = {(uint8_t)(RN_COMMAND_CMD | reg), value};
+    return this->transfer(buf, sizeof(buf), nullptr, 0);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Read 8 bit value from device register
+    @param    reg     Register to be read
+    @param    value   Reference to 8-bit value of register
+    @return   TCS34725_OK or error code
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725::I2C_read_8(uint8_t reg, uint8_t &value) {
+    uint8_t cmd = RN_COMMAND_CMD | reg;
+    return this->transfer(&cmd, 1, &value, 1);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Write sequence of device registers using auto-increment protocol
+    @param    reg     First register to edit
+    @param    values  Pointer to new values
+    @param    len     Number of registers, up to SHADOW_SIZE
+    @return   TCS34725_OK or error code
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725::I2C_write_block(uint8_t reg, const uint8_t *values, uint8_t len) {
+    uint8_t buf[SHADOW_SIZE + 1];
+    buf[0] = RN_COMMAND_CMD | RN_COMMAND_TYPE_AUTOINC | reg;
+    memcpy(buf + 1, values, len);
+    return this->transfer(buf, len + 1, nullptr, 0);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Read sequence of device registers using auto-increment protocol
+    @param    reg     First register to be read
+    @param    buf     Pointer to buffer for register values
+    @param    len     Number of registers to be read
+    @return   TCS34725_OK or error code
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725::I2C_read_block(uint8_t reg, uint8_t *buf, uint8_t len) {
+    uint8_t cmd = RN_COMMAND_CMD | RN_COMMAND_TYPE_AUTOINC | reg;
+    return this->transfer(&cmd, 1, buf, len);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Read all RGBC data registers (CDATAL..BDATAH) in one transaction
+    @param    value   Reference to structure for RGBC values
+    @return   TCS34725_OK or error code
+    @note     Reading the whole block at once returns values of the same
+              integration cycle, as device latches the upper bytes
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725::readRGBC(RGBC_value_t &value) {
+    uint8_t buf[8];
+    uint8_t status = this->I2C_read_block(RN_CDATAL, buf, sizeof(buf));
+    if (status != TCS34725_OK)
+        return status;
+    unpackRGBC(buf, value);
+    return TCS34725_OK;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Read STATUS and all RGBC data registers in one transaction
+    @param    value   Reference to structure for RGBC values
+    @param    valid   Reference to AVALID flag, values are not valid if false
+    @return   TCS34725_OK or error code
+    @note     STATUS precedes CDATAL, so polling costs no extra transaction
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725::readStatusRGBC(RGBC_value_t &value, bool &valid) {
+    uint8_t buf[9];
+    valid = false;
+    uint8_t status = this->I2C_read_block(RN_STATUS, buf, sizeof(buf));
+    if (status != TCS34725_OK)
+        return status;
+    valid = buf[0] & RN_STATUS_AVALID;
+    unpackRGBC(buf + 1, value);
+    return TCS34725_OK;
+}
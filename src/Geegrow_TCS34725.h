@@ -18,6 +18,13 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include "defines.h"
+#include "Geegrow_TCS34725_Types.h"
+#include "Geegrow_TCS34725_Timing.h"
+#include "Geegrow_TCS34725_Bus.h"
+#include "Geegrow_TCS34725_Filter.h"
+#include "Geegrow_TCS34725_Color.h"
+#include "Geegrow_TCS34725_RingBuffer.h"
+#include "Geegrow_TCS34725_Trace.h"
 
 /******************************************************************************/
 /*!
@@ -27,13 +34,109 @@
 #define TCS34725_I2C_ADDRESS   0x29
 
 #define CALIBRATION_TIME       5000
-#define MAX_CALIB_TABLE_SIZE   10
+/* Rows of calibration table enough for calibrate(), storage is given by
+   setCalibrationStorage(). Tables up to 255 rows are allowed, lookup time
+   grows only logarithmically with size */
+#define CALIB_TABLE_SIZE       10
+/* Rows needed to interpolate, smaller tables are not stored or loaded */
+#define MIN_CALIB_TABLE_SIZE   2
 
-struct RGBC_value_t {
-    uint16_t red;
-    uint16_t green;
-    uint16_t blue;
-    uint16_t clear;
+/* Configuration registers cached by driver: ENABLE..CONTROL */
+#define SHADOW_SIZE            (RN_CONTROL + 1)
+#define SHADOW_REGS            ((1 << RN_ENABLE) | (1 << RN_ATIME) | (1 << RN_WTIME) | \
+                                (1 << RN_AILTL) | (1 << RN_AILTH) | (1 << RN_AIHTL) | \
+                                (1 << RN_AIHTH) | (1 << RN_PERS) | (1 << RN_CONFIG) | \
+                                (1 << RN_CONTROL))
+
+/* Bus transactions retried on error, can be changed by setRetries() */
+#ifndef I2C_RETRIES
+#define I2C_RETRIES            2
+#endif
+
+/* Time in ms getRawData waits for result after cycle period */
+#ifndef ACQUISITION_TIMEOUT
+#define ACQUISITION_TIMEOUT    100
+#endif
+
+/* Status codes */
+#define TCS34725_OK                 0
+#define TCS34725_ERR_NACK           1    /* Device didn't acknowledge transfer */
+#define TCS34725_ERR_SHORT_READ     2    /* Less bytes received than requested */
+#define TCS34725_ERR_TIMEOUT        3    /* Bus or result wait timed out */
+
+/* Format version of stored calibration blob */
+#define CALIB_BLOB_VERSION     1
+
+/* EEPROM storage of calibration is built for AVR cores only, other cores
+   lack EEPROM.update() or need begin() and commit(). Buffer and stream
+   functions work on any core */
+#ifndef TCS34725_HAS_EEPROM
+#if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_MEGAAVR)
+#define TCS34725_HAS_EEPROM    1
+#else
+#define TCS34725_HAS_EEPROM    0
+#endif
+#endif
+
+/* Typical supply current of device in states, uA */
+#define ACTIVE_CURRENT_UA      235
+#define WAIT_CURRENT_UA        65
+
+/* Clear value bounds of auto-ranging, percents of saturation level */
+#define AUTO_RANGE_HIGH        90
+#define AUTO_RANGE_TARGET      50
+#define AUTO_RANGE_LOW         10
+
+/* Buffer of samples collected in interrupt mode, owned by caller */
+typedef Geegrow_TCS34725_RingBuffer<RGBC_value_t> Geegrow_TCS34725_SampleBuffer;
+template<uint8_t SIZE>
+using Geegrow_TCS34725_StaticSampleBuffer = Geegrow_TCS34725_StaticRingBuffer<RGBC_value_t, SIZE>;
+
+/******************************************************************************/
+/*!
+    @brief    Counters of bus activity and errors
+ */
+/******************************************************************************/
+struct TCS34725_Stats_t {
+    uint32_t transactions;    /* Write and read transfers on bus */
+    uint32_t bytes;           /* Bytes on bus including command byte */
+    uint16_t nacks;           /* Writes not acknowledged */
+    uint16_t shortReads;      /* Reads returning less bytes than requested */
+    uint16_t retries;         /* Repeated transactions */
+    uint16_t timeouts;        /* Results not ready in time, bus timeouts */
+    uint32_t busTime;         /* Time spent in bus transactions, us */
+    uint32_t waitTime;        /* Time blocked in getRawData, us */
+};
+
+/* Reports number of recorded calibration samples out of total */
+typedef void (*CalibrationCallback_t)(uint8_t count, uint8_t total);
+
+/******************************************************************************/
+/*!
+    @brief    Fixed-point scale of one calibration row
+    @note     Channel value in 255 format is (raw * mul) >> shift.
+              Span fields hold Q15 reciprocal of clear distance to the next
+              row for interpolation
+ */
+/******************************************************************************/
+struct CalibScale_t {
+    uint16_t mul[3];
+    uint8_t shift[3];
+    uint16_t spanMul;
+    uint8_t spanShift;
+};
+
+/******************************************************************************/
+/*!
+    @brief    Storage of calibration table with N rows
+    @note     Pass it to setCalibrationStorage() of driver before any
+              calibration, driver has no table of its own
+ */
+/******************************************************************************/
+template<uint8_t N>
+struct Geegrow_TCS34725_CalibStorage {
+    RGBC_value_t values[N];
+    CalibScale_t scales[N];
 };
 
 /******************************************************************************/
@@ -48,37 +151,228 @@ class Geegrow_TCS34725 {
             uint8_t time = RN_ATIME_INTEG_TIME_154,
             uint8_t gain = RN_CONTROL_GAIN_1X
         );
+        Geegrow_TCS34725(
+            Geegrow_TCS34725_Bus &bus,
+            uint8_t i2c_addr = TCS34725_I2C_ADDRESS,
+            uint8_t time = RN_ATIME_INTEG_TIME_154,
+            uint8_t gain = RN_CONTROL_GAIN_1X
+        );
+        template<uint8_t ATIME, uint8_t GAIN>
+        Geegrow_TCS34725(
+            Geegrow_TCS34725_Config<ATIME, GAIN> config,
+            uint8_t i2c_addr = TCS34725_I2C_ADDRESS
+        );
+        template<uint8_t ATIME, uint8_t GAIN>
+        Geegrow_TCS34725(
+            Geegrow_TCS34725_Bus &bus,
+            Geegrow_TCS34725_Config<ATIME, GAIN> config,
+            uint8_t i2c_addr = TCS34725_I2C_ADDRESS
+        );
+        template<uint8_t ATIME, uint8_t GAIN>
+        void setConfig(Geegrow_TCS34725_Config<ATIME, GAIN> config);
         void enable();
         void disable();
-        void getRawData(int16_t &red, int16_t &green, int16_t &blue, int16_t &clear);
-        void getRGB_255(int16_t &red, int16_t &green, int16_t &blue);
+        uint8_t getRawData(int16_t &red, int16_t &green, int16_t &blue, int16_t &clear);
+        uint8_t getRawData(RGBC_value_t &value);
+        void startConversion();
+        bool isReady();
+        bool readIfReady(RGBC_value_t &value);
+        uint8_t getRGB_255(int16_t &red, int16_t &green, int16_t &blue);
+        void convertRGB_255(const RGBC_value_t &value, int16_t &red, int16_t &green, int16_t &blue);
         void enableIRQ();
         void disableIRQ();
         void clearIRQ();
-        void setLimitsIRQ(int16_t high, int16_t low);
-        void calibrate();
-        void calibrateManual(RGBC_value_t* array, uint8_t size);
-        RGBC_value_t* getCalibrationValues(uint8_t &size);
-
-    private:
+        void setLimitsIRQ(uint16_t high, uint16_t low);
+        void sync();
+        void refresh();
+        void setRetries(uint8_t retries);
+        void setTimeout(uint16_t timeout);
+        uint8_t getLastError();
+        void getStats(TCS34725_Stats_t &stats);
+        void resetStats();
+        void setPersistence(uint8_t persistence);
+        void beginInterruptMode(Geegrow_TCS34725_SampleBuffer &buffer, uint8_t persistence = RN_PERS_CONSEQ_VAL_0);
+        void endInterruptMode();
+        void enableChangeDetection(Geegrow_TCS34725_SampleBuffer &buffer, uint16_t band, uint8_t persistence = RN_PERS_CONSEQ_VAL_1);
+        void disableChangeDetection();
+        void onInterrupt();
+        uint8_t processIRQ();
+        bool readSample(RGBC_value_t &value);
+        uint8_t samplesAvailable();
+        void getDroppedSamples(uint16_t &overflow, uint16_t &missed);
         void setIntegrationTime(uint8_t integrationTime);
         void setGain(uint8_t gain);
-        void I2C_write_8(uint8_t reg, uint8_t value);
-        uint8_t I2C_read_8(uint8_t reg);
-        uint16_t I2C_read_16(uint8_t reg);
+        void setAutoRange(bool enable);
+        void setFilter(Geegrow_TCS34725_Filter *filter);
+        void setColor(Geegrow_TCS34725_Color *color);
+        void setTraceWriter(Geegrow_TCS34725_TraceWriter *writer);
+        bool injectSample(RGBC_value_t &value);
+        uint32_t setSamplePeriod(uint32_t period);
+        uint32_t getSamplePeriod();
+        uint32_t getIntegrationTime_us();
+        uint16_t getAverageCurrent();
+        bool calibrate();
+        bool beginCalibration(RGBC_value_t *staging, uint8_t samples, uint16_t interval);
+        void cancelCalibration();
+        bool isCalibrating();
+        void setCalibrationCallbacks(CalibrationCallback_t progress, CalibrationCallback_t complete);
+        bool addCalibrationSample(const RGBC_value_t &value);
+        bool calibrateManual(const RGBC_value_t* array, uint8_t size);
+        const RGBC_value_t* getCalibrationValues(uint8_t &size);
+        uint8_t getCalibrationCapacity();
+        bool setCalibrationStorage(RGBC_value_t *values, CalibScale_t *scales, uint8_t capacity);
+        template<uint8_t N>
+        bool setCalibrationStorage(Geegrow_TCS34725_CalibStorage<N> &storage);
+        uint16_t getCalibrationBlobSize();
+        uint16_t exportCalibration(uint8_t *buf, uint16_t len);
+        bool importCalibration(const uint8_t *buf, uint16_t len);
+        uint16_t writeCalibration(Print &out);
+        bool readCalibration(Stream &in, RGBC_value_t *staging, uint8_t size);
+#if TCS34725_HAS_EEPROM
+        bool saveCalibration(uint16_t address);
+        bool loadCalibration(uint16_t address);
+#endif
+
+        static void calcReciprocal(uint32_t num, uint8_t maxShift, uint16_t den, uint16_t &mul, uint8_t &shift);
+
+    private:
+        typedef bool (*ByteWriter)(void *ctx, uint16_t index, uint8_t value);
+        typedef int16_t (*ByteReader)(void *ctx, uint16_t index);
+        uint16_t encodeCalibration(ByteWriter writer, void *ctx);
+        uint8_t decodeCalibration(ByteReader reader, void *ctx, RGBC_value_t *rows, uint8_t size);
+        bool processSample(RGBC_value_t &value);
+        void updateRange(uint16_t clear);
+        void updateNormalization();
+        void updateColorConfig();
+        void updateChangeLimits(uint16_t clear);
+        void setWaitTime(uint16_t cycles, bool waitLong);
+        uint32_t getWaitTime_us();
+        void writeReg(uint8_t reg, uint8_t value);
+        void writeRegs(uint8_t reg, const uint8_t *values, uint8_t len);
+        uint8_t readReg(uint8_t reg, uint8_t &value);
+        bool isCached(uint8_t reg, uint8_t value);
+        uint8_t transfer(const uint8_t *tx, uint8_t txLen, uint8_t *rx, uint8_t rxLen);
+        uint8_t I2C_write_8(uint8_t reg, uint8_t value);
+        uint8_t I2C_write_block(uint8_t reg, const uint8_t *values, uint8_t len);
+        uint8_t I2C_read_8(uint8_t reg, uint8_t &value);
+        void loadTable(const RGBC_value_t *array, uint8_t size);
+        void calcCoefficients();
+        void calcRow(uint8_t row);
+        uint8_t I2C_read_block(uint8_t reg, uint8_t *buf, uint8_t len);
+        uint8_t readRGBC(RGBC_value_t &value);
+        uint8_t readStatusRGBC(RGBC_value_t &value, bool &valid);
+        bool isDue();
 
-        uint16_t currentIntegrationTime = 0;
+        /* Integration and wait time, us */
+        uint32_t currentCyclePeriod = 0;
+        uint8_t currentATIME = 0;
+        uint16_t currentWaitCycles = 0;
+        bool currentWaitLong = false;
         uint8_t currentGain = 0;
+        bool autoRange = false;
+        uint8_t refATIME = 0;
+        uint8_t refGain = 0;
+        uint16_t normMul = 0;
+        uint8_t normShift = 0;
+        /* Optional stages are owned by caller, nullptr if not used */
+        Geegrow_TCS34725_Filter *filter = nullptr;
+        Geegrow_TCS34725_Color *color = nullptr;
+        Geegrow_TCS34725_TraceWriter *traceWriter = nullptr;
         uint8_t i2c_addr = 0;
+        Geegrow_TCS34725_Bus *bus = nullptr;
+        uint8_t shadow[SHADOW_SIZE];
+        uint16_t shadowValid = 0;
+        uint8_t retries = I2C_RETRIES;
+        uint16_t timeout = ACQUISITION_TIMEOUT;
+        uint8_t lastError = TCS34725_OK;
+        TCS34725_Stats_t stats = {};
 
-        int8_t calibTableSize = 0;
-        float calibCoef[MAX_CALIB_TABLE_SIZE][4];
-        RGBC_value_t* calibValues;
+        bool conversionActive = false;
+        /* Start of integration of awaited cycle, ahead during wait state */
+        uint32_t conversionStart = 0;
+
+        Geegrow_TCS34725_SampleBuffer *irqBuffer = nullptr;
+        volatile bool irqPending = false;
+        volatile uint32_t irqTimestamp = 0;
+        uint16_t irqOverflow = 0;
+        uint16_t irqMissed = 0;
+
+        bool changeActive = false;
+        bool changeCentred = false;
+        uint16_t changeBand = 0;
+        uint16_t changeCentre = 0;
+        /* Interrupt setup replaced by change detection, restored when it stops */
+        uint8_t changeSavedLimits[4] = {};
+        uint8_t changeSavedPers = 0;
+        bool changeSavedIrq = false;
+        Geegrow_TCS34725_SampleBuffer *changeSavedBuffer = nullptr;
+
+        uint8_t calibTableSize = 0;
+        bool calibActive = false;
+        /* Samples of running calibration, active table is kept until done */
+        RGBC_value_t *calibStaging = nullptr;
+        uint8_t calibCount = 0;
+        uint8_t calibTarget = 0;
+        uint16_t calibInterval = 0;
+        uint32_t calibLastSample = 0;
+        CalibrationCallback_t calibProgressCb = nullptr;
+        CalibrationCallback_t calibCompleteCb = nullptr;
+        /* Table storage is owned by caller, none until it is given */
+        RGBC_value_t *calibValues = nullptr;
+        CalibScale_t *calibScale = nullptr;
+        uint8_t calibCapacity = 0;
         uint8_t calibMaxValueIndex = 0;
 };
 
-namespace Tools {
-    void bubble_sort(RGBC_value_t *array, uint8_t array_size);
-};
+/******************************************************************************/
+/*!
+    @brief    Constructor
+    @param    config      Configuration fixed at compile time
+    @param    i2c_addr    I2C address of device
+ */
+/******************************************************************************/
+template<uint8_t ATIME, uint8_t GAIN>
+Geegrow_TCS34725::Geegrow_TCS34725(Geegrow_TCS34725_Config<ATIME, GAIN> config, uint8_t i2c_addr)
+    : Geegrow_TCS34725(i2c_addr, config.atime, config.gain) {
+}
+
+/******************************************************************************/
+/*!
+    @brief    Constructor
+    @param    bus         Transport for register access
+    @param    config      Configuration fixed at compile time
+    @param    i2c_addr    I2C address of device
+ */
+/******************************************************************************/
+template<uint8_t ATIME, uint8_t GAIN>
+Geegrow_TCS34725::Geegrow_TCS34725(Geegrow_TCS34725_Bus &bus, Geegrow_TCS34725_Config<ATIME, GAIN> config, uint8_t i2c_addr)
+    : Geegrow_TCS34725(bus, i2c_addr, config.atime, config.gain) {
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets storage of calibration table owned by caller
+    @param    storage     Storage of N rows, must outlive driver
+    @return   True if storage is accepted
+    @note     See setCalibrationStorage(values, scales, capacity)
+ */
+/******************************************************************************/
+template<uint8_t N>
+bool Geegrow_TCS34725::setCalibrationStorage(Geegrow_TCS34725_CalibStorage<N> &storage) {
+    return this->setCalibrationStorage(storage.values, storage.scales, N);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets integration time and gain fixed at compile time
+    @param    config  Configuration, e.g.
+                      Geegrow_TCS34725_Config<RN_ATIME_INTEG_TIME_24, RN_CONTROL_GAIN_4X>()
+ */
+/******************************************************************************/
+template<uint8_t ATIME, uint8_t GAIN>
+void Geegrow_TCS34725::setConfig(Geegrow_TCS34725_Config<ATIME, GAIN> config) {
+    this->setIntegrationTime(config.atime);
+    this->setGain(config.gain);
+}
 
 #endif /* GEEGROW_TCS34725_H */
\ No newline at end of file
@@ -0,0 +1,73 @@
+/*!
+ * @file Geegrow_TCS34725_Array.cpp
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Geegrow_TCS34725_Array.h"
+
+/******************************************************************************/
+/*!
+    @brief    Constructor
+    @param    sensors     Pointer to array of pointers to sensors
+    @param    count       Number of sensors in array
+ */
+/******************************************************************************/
+Geegrow_TCS34725_Array::Geegrow_TCS34725_Array(Geegrow_TCS34725 **sensors, uint8_t count) {
+    this->sensors = sensors;
+    this->count = count;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Starts staggered acquisition
+    @note     Only the first sensor is started here, others are started by
+              poll() when their offset expires
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Array::begin() {
+    this->started = 0;
+    this->next = 0;
+    this->startTime = micros();
+    if (this->count == 0)
+        return;
+    this->sensors[0]->startConversion();
+    this->started = 1;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Takes a fresh sample from the next sensor having one, round-robin
+    @param    index   Reference to index of sensor the sample belongs to
+    @param    value   Reference to structure for RGBC values
+    @return   True if value was updated
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725_Array::poll(uint8_t &index, RGBC_value_t &value) {
+    /* Start next sensor at its share of sample period */
+    if (this->started && this->started < this->count) {
+        uint32_t offset = this->sensors[this->started]->getSamplePeriod() / this->count * this->started;
+        if ((uint32_t)(micros() - this->startTime) >= offset) {
+            this->sensors[this->started]->startConversion();
+            this->started++;
+        }
+    }
+
+    for (uint8_t i = 0; i < this->started; i++) {
+        uint8_t n = this->next;
+        this->next = (n + 1 < this->started) ? n + 1 : 0;
+        if (this->sensors[n]->readIfReady(value)) {
+            index = n;
+            return true;
+        }
+    }
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+/*!
+ * @file Geegrow_TCS34725_Array.h
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef GEEGROW_TCS34725_ARRAY_H
+#define GEEGROW_TCS34725_ARRAY_H
+
+#include "Geegrow_TCS34725.h"
+
+/******************************************************************************/
+/*!
+    @brief    Collects samples from several sensors without blocking
+    @note     Integration of sensors is started with even offsets over the
+              sample period, so their results become valid one after another
+              and bus reads are spread in time
+ */
+/******************************************************************************/
+class Geegrow_TCS34725_Array {
+    public:
+        Geegrow_TCS34725_Array(Geegrow_TCS34725 **sensors, uint8_t count);
+        void begin();
+        bool poll(uint8_t &index, RGBC_value_t &value);
+
+    private:
+        Geegrow_TCS34725 **sensors = nullptr;
+        uint8_t count = 0;
+        /* Number of sensors with started integration */
+        uint8_t started = 0;
+        /* Sensor to be checked first on next poll */
+        uint8_t next = 0;
+        uint32_t startTime = 0;
+};
+
+#endif /* GEEGROW_TCS34725_ARRAY_H */
\ No newline at end of file
@@ -0,0 +1,200 @@
+/*!
+ * @file Geegrow_TCS34725_Bus.cpp
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Geegrow_TCS34725_Bus.h"
+
+/******************************************************************************/
+/*!
+    @brief    Constructor
+    @param    wire        Reference to TwoWire interface
+    @param    timeout     Bus timeout in us, 0 to wait forever. Used only on
+                          cores defining WIRE_HAS_TIMEOUT
+ */
+/******************************************************************************/
+Geegrow_TCS34725_WireBus::Geegrow_TCS34725_WireBus(TwoWire &wire, uint32_t timeout)
+    : wire(wire), timeout(timeout) {
+}
+
+/******************************************************************************/
+/*!
+    @brief    Initializes TwoWire interface and its timeout
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_WireBus::begin() {
+    this->wire.begin();
+#ifdef WIRE_HAS_TIMEOUT
+    /* Timed out transaction returns 5 and TwoWire is reset */
+    this->wire.setWireTimeout(this->timeout, true);
+#endif
+}
+
+/******************************************************************************/
+/*!
+    @brief    Writes bytes to device in one transaction
+    @param    addr    I2C address of device
+    @param    data    Pointer to bytes to be sent
+    @param    len     Number of bytes
+    @return   Status of endTransmission(), 0 on success
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_WireBus::write(uint8_t addr, const uint8_t *data, uint8_t len) {
+    this->wire.beginTransmission(addr);
+    this->wire.write(data, len);
+    return this->wire.endTransmission();
+}
+
+/******************************************************************************/
+/*!
+    @brief    Reads bytes from device in one transaction
+    @param    addr    I2C address of device
+    @param    data    Pointer to buffer for received bytes
+    @param    len     Number of bytes
+    @return   Number of received bytes
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_WireBus::read(uint8_t addr, uint8_t *data, uint8_t len) {
+    uint8_t received = this->wire.requestFrom(addr, len);
+    for (uint8_t i = 0; i < received; i++)
+        data[i] = this->wire.read();
+    return received;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Constructor
+    @param    bus     Transport of the bus multiplexer is connected to
+    @param    addr    I2C address of multiplexer
+ */
+/******************************************************************************/
+Geegrow_TCS34725_Mux::Geegrow_TCS34725_Mux(Geegrow_TCS34725_Bus &bus, uint8_t addr) : bus(bus), addr(addr) {
+}
+
+/******************************************************************************/
+/*!
+    @brief    Initializes parent bus once for all channels
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Mux::begin() {
+    if (this->initialized)
+        return;
+    this->bus.begin();
+    this->initialized = true;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Switches multiplexer to channel if it is not selected yet
+    @param    channel     Number of channel (0..7)
+    @return   0 on success like endTransmission()
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_Mux::select(uint8_t channel) {
+    if (channel == this->channel)
+        return 0;
+    uint8_t mask = 1 << channel;
+    uint8_t status = this->bus.write(this->addr, &mask, 1);
+    this->channel = status ? 0xFF : channel;
+    return status;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get transport of the bus multiplexer is connected to
+    @return   Reference to transport
+ */
+/******************************************************************************/
+Geegrow_TCS34725_Bus &Geegrow_TCS34725_Mux::getBus() {
+    return this->bus;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Constructor
+    @param    mux         Reference to multiplexer
+    @param    channel     Number of channel device is connected to
+ */
+/******************************************************************************/
+Geegrow_TCS34725_MuxBus::Geegrow_TCS34725_MuxBus(Geegrow_TCS34725_Mux &mux, uint8_t channel) : mux(mux), channel(channel) {
+}
+
+/******************************************************************************/
+/*!
+    @brief    Initializes multiplexer
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_MuxBus::begin() {
+    this->mux.begin();
+}
+
+/******************************************************************************/
+/*!
+    @brief    Selects channel and writes bytes to device in one transaction
+    @param    addr    I2C address of device
+    @param    data    Pointer to bytes to be sent
+    @param    len     Number of bytes
+    @return   0 on success like endTransmission()
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_MuxBus::write(uint8_t addr, const uint8_t *data, uint8_t len) {
+    uint8_t status = this->mux.select(this->channel);
+    if (status)
+        return status;
+    return this->mux.getBus().write(addr, data, len);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Selects channel and reads bytes from device in one transaction
+    @param    addr    I2C address of device
+    @param    data    Pointer to buffer for received bytes
+    @param    len     Number of bytes
+    @return   Number of received bytes
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_MuxBus::read(uint8_t addr, uint8_t *data, uint8_t len) {
+    if (this->mux.select(this->channel))
+        return 0;
+    return this->mux.getBus().read(addr, data, len);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Accepts write transaction
+    @param    addr    I2C address of device
+    @param    data    Pointer to bytes to be sent
+    @param    len     Number of bytes
+    @return   0, as on success
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_NullBus::write(uint8_t addr, const uint8_t *data, uint8_t len) {
+    (void)addr;
+    (void)data;
+    (void)len;
+    return 0;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Returns zeros for read transaction
+    @param    addr    I2C address of device
+    @param    data    Pointer to buffer for received bytes
+    @param    len     Number of bytes
+    @return   Number of bytes, as on success
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_NullBus::read(uint8_t addr, uint8_t *data, uint8_t len) {
+    (void)addr;
+    memset(data, 0, len);
+    return len;
+}
\ No newline at end of file
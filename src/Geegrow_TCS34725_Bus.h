@@ -0,0 +1,113 @@
+/*!
+ * @file Geegrow_TCS34725_Bus.h
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef GEEGROW_TCS34725_BUS_H
+#define GEEGROW_TCS34725_BUS_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+/* Bus timeout set by Geegrow_TCS34725_WireBus, us, default of AVR core */
+#define WIRE_BUS_TIMEOUT    25000
+
+/******************************************************************************/
+/*!
+    @brief    Transport used by driver for all register access
+    @note     Implement it to run the driver on another bus, or on a simulated
+              device in a host build
+ */
+/******************************************************************************/
+class Geegrow_TCS34725_Bus {
+    public:
+        virtual ~Geegrow_TCS34725_Bus() {}
+        virtual void begin() {}
+        /* One write transaction, returns 0 on success like endTransmission() */
+        virtual uint8_t write(uint8_t addr, const uint8_t *data, uint8_t len) = 0;
+        /* One read transaction, returns number of received bytes */
+        virtual uint8_t read(uint8_t addr, uint8_t *data, uint8_t len) = 0;
+};
+
+/******************************************************************************/
+/*!
+    @brief    Transport over Arduino TwoWire interface
+    @note     On cores defining WIRE_HAS_TIMEOUT (AVR since 1.8.3, megaAVR)
+              begin() enables bus timeout with reset of TwoWire, so a device
+              holding SDA low makes a transaction fail with timeout. Other
+              cores have their own timeouts or none, there a stuck bus may
+              block the driver in endTransmission() or requestFrom()
+ */
+/******************************************************************************/
+class Geegrow_TCS34725_WireBus : public Geegrow_TCS34725_Bus {
+    public:
+        Geegrow_TCS34725_WireBus(TwoWire &wire, uint32_t timeout = WIRE_BUS_TIMEOUT);
+        void begin() override;
+        uint8_t write(uint8_t addr, const uint8_t *data, uint8_t len) override;
+        uint8_t read(uint8_t addr, uint8_t *data, uint8_t len) override;
+
+    private:
+        TwoWire &wire;
+        uint32_t timeout = 0;
+};
+
+/******************************************************************************/
+/*!
+    @brief    I2C multiplexer of TCA9548A type, shared by its channels
+ */
+/******************************************************************************/
+class Geegrow_TCS34725_Mux {
+    public:
+        Geegrow_TCS34725_Mux(Geegrow_TCS34725_Bus &bus, uint8_t addr = 0x70);
+        void begin();
+        uint8_t select(uint8_t channel);
+        Geegrow_TCS34725_Bus &getBus();
+
+    private:
+        Geegrow_TCS34725_Bus &bus;
+        uint8_t addr = 0;
+        /* Channel currently switched on, 0xFF if unknown */
+        uint8_t channel = 0xFF;
+        bool initialized = false;
+};
+
+/******************************************************************************/
+/*!
+    @brief    Transport to device behind one channel of multiplexer
+    @note     Mux is switched only when channel differs from the last one used
+ */
+/******************************************************************************/
+class Geegrow_TCS34725_MuxBus : public Geegrow_TCS34725_Bus {
+    public:
+        Geegrow_TCS34725_MuxBus(Geegrow_TCS34725_Mux &mux, uint8_t channel);
+        void begin() override;
+        uint8_t write(uint8_t addr, const uint8_t *data, uint8_t len) override;
+        uint8_t read(uint8_t addr, uint8_t *data, uint8_t len) override;
+
+    private:
+        Geegrow_TCS34725_Mux &mux;
+        uint8_t channel = 0;
+};
+
+/******************************************************************************/
+/*!
+    @brief    Transport without device, every transaction succeeds
+    @note     Use it to run driver on recorded data, e.g. for trace replay
+ */
+/******************************************************************************/
+class Geegrow_TCS34725_NullBus : public Geegrow_TCS34725_Bus {
+    public:
+        uint8_t write(uint8_t addr, const uint8_t *data, uint8_t len) override;
+        uint8_t read(uint8_t addr, uint8_t *data, uint8_t len) override;
+};
+
+#endif /* GEEGROW_TCS34725_BUS_H */
\ No newline at end of file
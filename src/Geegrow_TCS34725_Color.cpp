@@ -0,0 +1,359 @@
+/*!
+ * @file Geegrow_TCS34725_Color.cpp
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Geegrow_TCS34725_Color.h"
+#include "Geegrow_TCS34725.h"
+
+/* Default RGB to XYZ matrix of TCS3x7x family, Q12 */
+static const int16_t defaultMatrix[9] = {
+    -585,   6346,  -3917,
+    -1330,  6465,  -2998,
+    -2794,  3157,   2307
+};
+
+/* Largest ratio to white point accepted by L*a*b* conversion, Q16 */
+#define LAB_MAX_RATIO    ((1UL << 18) - 1)
+/* (6/29)^3 in Q16, border of linear segment of L*a*b* function */
+#define LAB_EPSILON      580
+/* 4/29 in Q12 */
+#define LAB_OFFSET       565
+
+/******************************************************************************/
+/*!
+    @brief    Saturates value to int16_t range
+    @param    value   Value to saturate
+    @return   Saturated value
+ */
+/******************************************************************************/
+static int16_t saturate16(int32_t value) {
+    return (value > 32767) ? 32767 : ((value < -32768) ? -32768 : value);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Constructor
+    @note     White point is D65 scaled to Y = 50000 counts, replace it by XYZ
+              of real white sample with setWhitePoint()
+ */
+/******************************************************************************/
+Geegrow_TCS34725_Color::Geegrow_TCS34725_Color() {
+    this->setMatrix(defaultMatrix);
+    this->white.X = 47524;
+    this->white.Y = 50000;
+    this->white.Z = 54442;
+    this->setConfig(RN_ATIME_INTEG_TIME_154, RN_CONTROL_GAIN_1X);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets integration time and gain samples were taken with
+    @param    atime   Value of ATIME register
+    @param    gain    Value of CONTROL register
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Color::setConfig(uint8_t atime, uint8_t gain) {
+    uint16_t cycles = TCS34725_cycles(atime);
+    this->saturation = TCS34725_saturation(cycles);
+
+    /* lux = G' * DF / CPL, CPL = 2.4 ms * cycles * gain. Both sides are
+       divided by 8 to keep numerator in 16 bits */
+    static_assert((COLOR_LUX_DF * 10UL * COLOR_LUX_SCALE) % 8 == 0 &&
+                  (COLOR_LUX_DF * 10UL * COLOR_LUX_SCALE) / 8 <= 0xFFFF,
+                  "Lux numerator must fit into 16 bits");
+    Geegrow_TCS34725::calcReciprocal(COLOR_LUX_DF * 10UL * COLOR_LUX_SCALE / 8, 16,
+                                     3 * TCS34725_sensitivity(gain, cycles),
+                                     this->luxMul, this->luxShift);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets RGB to XYZ matrix
+    @param    matrix  Row-major coefficients in Q12 (4096 is 1.0)
+    @note     Sum of absolute values of a row must not exceed 32767. Matrix
+              is applied to channels with IR component removed
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Color::setMatrix(const int16_t matrix[9]) {
+    for (uint8_t i = 0; i < 9; i++)
+        this->matrix[i] = matrix[i];
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get RGB to XYZ matrix
+    @param    matrix  Array for row-major coefficients in Q12
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Color::getMatrix(int16_t matrix[9]) {
+    for (uint8_t i = 0; i < 9; i++)
+        matrix[i] = this->matrix[i];
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets reference white for L*a*b* conversion
+    @param    white   XYZ values of white sample, e.g. from toXYZ()
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Color::setWhitePoint(const Color_XYZ_t &white) {
+    this->white.X = white.X ? white.X : 1;
+    this->white.Y = white.Y ? white.Y : 1;
+    this->white.Z = white.Z ? white.Z : 1;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Checks if sample is clipped by device
+    @param    value   Reference to structure with raw RGBC values
+    @return   True if clear channel reached saturation level
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725_Color::isSaturated(const RGBC_value_t &value) {
+    return value.clear >= this->saturation;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Removes infrared component from color channels
+    @param    value   Reference to structure with raw RGBC values
+    @param    out     Reference to structure for R', G', B' and C' values
+    @note     IR = (R + G + B - C) / 2, as clear channel has no IR filter
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Color::removeIR(const RGBC_value_t &value, RGBC_value_t &out) {
+    int32_t ir = ((int32_t)value.red + value.green + value.blue - value.clear) / 2;
+    uint16_t t = (ir > 0) ? ir : 0;
+    out.red   = (value.red > t) ? value.red - t : 0;
+    out.green = (value.green > t) ? value.green - t : 0;
+    out.blue  = (value.blue > t) ? value.blue - t : 0;
+    out.clear = (value.clear > t) ? value.clear - t : 0;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Calculates illuminance
+    @param    value   Reference to structure with raw RGBC values
+    @return   Illuminance in 1/COLOR_LUX_SCALE lux
+    @note     Result is not valid for saturated samples, see isSaturated()
+ */
+/******************************************************************************/
+uint32_t Geegrow_TCS34725_Color::getLux(const RGBC_value_t &value) {
+    RGBC_value_t v;
+    this->removeIR(value, v);
+    int32_t g = ((int32_t)COLOR_LUX_R_COEF * v.red + (int32_t)COLOR_LUX_G_COEF * v.green +
+                 (int32_t)COLOR_LUX_B_COEF * v.blue + 2048) >> 12;
+    if (g <= 0)
+        return 0;
+    if (g > 0xFFFF)
+        g = 0xFFFF;
+    return ((uint32_t)g * this->luxMul) >> this->luxShift;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Calculates correlated color temperature
+    @param    value   Reference to structure with raw RGBC values
+    @return   Temperature in K, 0 if there is no red component
+ */
+/******************************************************************************/
+uint16_t Geegrow_TCS34725_Color::getCCT(const RGBC_value_t &value) {
+    RGBC_value_t v;
+    this->removeIR(value, v);
+    if (v.red == 0)
+        return 0;
+    uint32_t cct = (uint32_t)COLOR_CT_COEF * v.blue / v.red + COLOR_CT_OFFSET;
+    return (cct > 0xFFFF) ? 0xFFFF : cct;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Converts sample to CIE XYZ
+    @param    value   Reference to structure with raw RGBC values
+    @param    xyz     Reference to structure for XYZ values
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Color::toXYZ(const RGBC_value_t &value, Color_XYZ_t &xyz) {
+    RGBC_value_t v;
+    this->removeIR(value, v);
+    uint16_t *out[3] = {&xyz.X, &xyz.Y, &xyz.Z};
+    for (uint8_t i = 0; i < 3; i++) {
+        const int16_t *m = &this->matrix[i * 3];
+        int32_t t = ((int32_t)m[0] * v.red + (int32_t)m[1] * v.green +
+                     (int32_t)m[2] * v.blue + 2048) >> 12;
+        *out[i] = (t < 0) ? 0 : ((t > 0xFFFF) ? 0xFFFF : t);
+    }
+}
+
+/******************************************************************************/
+/*!
+    @brief    Converts sample to CIE L*a*b*
+    @param    value   Reference to structure with raw RGBC values
+    @param    lab     Reference to structure for L*a*b* values
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Color::toLab(const RGBC_value_t &value, Color_Lab_t &lab) {
+    Color_XYZ_t xyz;
+    this->toXYZ(value, xyz);
+    this->toLab(xyz, lab);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Converts CIE XYZ to CIE L*a*b* relative to white point
+    @param    xyz     Reference to structure with XYZ values
+    @param    lab     Reference to structure for L*a*b* values
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Color::toLab(const Color_XYZ_t &xyz, Color_Lab_t &lab) {
+    uint32_t rx = ((uint32_t)xyz.X << 16) / this->white.X;
+    uint32_t ry = ((uint32_t)xyz.Y << 16) / this->white.Y;
+    uint32_t rz = ((uint32_t)xyz.Z << 16) / this->white.Z;
+    int32_t fx = labFunction(rx);
+    int32_t fy = labFunction(ry);
+    int32_t fz = labFunction(rz);
+    /* Colours far from white point exceed int16_t range, e.g. X of 4x
+       white point with Y = 0 gives a* = 724.5 */
+    lab.L = saturate16((11600L * fy - 16L * 100 * 4096) / 4096);
+    lab.a = saturate16((50000L * (fx - fy)) / 4096);
+    lab.b = saturate16((20000L * (fy - fz)) / 4096);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Converts sample to HSV
+    @param    value   Reference to structure with raw RGBC values
+    @param    hsv     Reference to structure for HSV values
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Color::toHSV(const RGBC_value_t &value, Color_HSV_t &hsv) {
+    RGBC_value_t v;
+    this->removeIR(value, v);
+    uint16_t max = v.red;
+    if (v.green > max) max = v.green;
+    if (v.blue > max) max = v.blue;
+    uint16_t min = v.red;
+    if (v.green < min) min = v.green;
+    if (v.blue < min) min = v.blue;
+    uint32_t delta = max - min;
+
+    uint32_t t = (uint32_t)max * 255 / this->saturation;
+    hsv.value = (t > 255) ? 255 : t;
+    hsv.saturation = max ? delta * 255 / max : 0;
+    if (delta == 0) {
+        hsv.hue = 0;
+        return;
+    }
+    /* Offsets keep numerators positive, so division rounds correctly */
+    int32_t n;
+    if (max == v.red)
+        n = 360L * delta + 60L * ((int32_t)v.green - v.blue);
+    else if (max == v.green)
+        n = 120L * delta + 60L * ((int32_t)v.blue - v.red);
+    else
+        n = 240L * delta + 60L * ((int32_t)v.red - v.green);
+    uint16_t hue = (n + delta / 2) / delta;
+    hsv.hue = (hue >= 360) ? hue - 360 : hue;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Calculates illuminance of array of samples
+    @param    values  Pointer to array of raw RGBC values
+    @param    lux     Pointer to array for results
+    @param    count   Number of samples
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Color::getLux(const RGBC_value_t *values, uint32_t *lux, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++)
+        lux[i] = this->getLux(values[i]);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Calculates correlated color temperature of array of samples
+    @param    values  Pointer to array of raw RGBC values
+    @param    cct     Pointer to array for results
+    @param    count   Number of samples
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Color::getCCT(const RGBC_value_t *values, uint16_t *cct, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++)
+        cct[i] = this->getCCT(values[i]);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Converts array of samples to CIE XYZ
+    @param    values  Pointer to array of raw RGBC values
+    @param    xyz     Pointer to array for results
+    @param    count   Number of samples
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Color::toXYZ(const RGBC_value_t *values, Color_XYZ_t *xyz, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++)
+        this->toXYZ(values[i], xyz[i]);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Converts array of samples to CIE L*a*b*
+    @param    values  Pointer to array of raw RGBC values
+    @param    lab     Pointer to array for results
+    @param    count   Number of samples
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Color::toLab(const RGBC_value_t *values, Color_Lab_t *lab, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++)
+        this->toLab(values[i], lab[i]);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Converts array of samples to HSV
+    @param    values  Pointer to array of raw RGBC values
+    @param    hsv     Pointer to array for results
+    @param    count   Number of samples
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Color::toHSV(const RGBC_value_t *values, Color_HSV_t *hsv, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++)
+        this->toHSV(values[i], hsv[i]);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Nonlinear function of L*a*b* conversion
+    @param    ratio   Ratio of tristimulus value to white point, Q16
+    @return   Cube root of ratio, or its linear approximation near zero, Q12
+ */
+/******************************************************************************/
+int32_t Geegrow_TCS34725_Color::labFunction(uint32_t ratio) {
+    if (ratio > LAB_MAX_RATIO)
+        ratio = LAB_MAX_RATIO;
+    if (ratio <= LAB_EPSILON)
+        /* ratio / (3 * (6/29)^2) + 4/29 */
+        return ratio * 841 / 1728 + LAB_OFFSET;
+    /* Newton iterations for cube root of ratio * 2^20, starting above the
+       root from the bit length of ratio, converge in four steps. Division
+       by y^2 / 2^7 keeps every product within 32 bits */
+    static const uint16_t guess[] = {1024, 1290, 1625, 2048, 2580, 3251, 4096, 5161, 6502};
+    uint8_t bits = 9;
+    while ((ratio >> (bits + 1)) != 0)
+        bits++;
+    uint32_t y = guess[bits - 9];
+    uint32_t x = ratio << 13;
+    for (uint8_t i = 0; i < 4; i++)
+        y = (2 * y + x / ((y * y + 64) >> 7)) / 3;
+    return y;
+}
\ No newline at end of file
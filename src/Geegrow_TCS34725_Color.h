@@ -0,0 +1,109 @@
+/*!
+ * @file Geegrow_TCS34725_Color.h
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef GEEGROW_TCS34725_COLOR_H
+#define GEEGROW_TCS34725_COLOR_H
+
+#include <Arduino.h>
+#include "defines.h"
+#include "Geegrow_TCS34725_Types.h"
+#include "Geegrow_TCS34725_Timing.h"
+
+/* Illuminance is returned in 1/COLOR_LUX_SCALE lux */
+#define COLOR_LUX_SCALE        100
+
+/* Coefficients of DN40 lux equation, Q12 */
+#define COLOR_LUX_R_COEF       557      /* 0.136 */
+#define COLOR_LUX_G_COEF       4096     /* 1.0 */
+#define COLOR_LUX_B_COEF       -1819    /* -0.444 */
+/* Device factor of DN40 lux equation, for open air (glass attenuation 1) */
+#define COLOR_LUX_DF           310
+
+/* Coefficients of DN40 CCT equation */
+#define COLOR_CT_COEF          3810
+#define COLOR_CT_OFFSET        1391
+
+/******************************************************************************/
+/*!
+    @brief    CIE 1931 tristimulus values in counts of device
+ */
+/******************************************************************************/
+struct Color_XYZ_t {
+    uint16_t X;
+    uint16_t Y;
+    uint16_t Z;
+};
+
+/******************************************************************************/
+/*!
+    @brief    CIE L*a*b* values in hundredths
+    @note     Values are saturated to -327.68..327.67
+ */
+/******************************************************************************/
+struct Color_Lab_t {
+    int16_t L;      /* 0..10000 */
+    int16_t a;
+    int16_t b;
+};
+
+/******************************************************************************/
+/*!
+    @brief    Hue, saturation and value
+ */
+/******************************************************************************/
+struct Color_HSV_t {
+    uint16_t hue;           /* 0..359 degrees */
+    uint8_t saturation;     /* 0..255 */
+    uint8_t value;          /* 0..255 of saturation level of device */
+};
+
+/******************************************************************************/
+/*!
+    @brief    Integer-only colour-science conversions of RGBC samples
+ */
+/******************************************************************************/
+class Geegrow_TCS34725_Color {
+    public:
+        Geegrow_TCS34725_Color();
+        void setConfig(uint8_t atime, uint8_t gain);
+        void setMatrix(const int16_t matrix[9]);
+        void getMatrix(int16_t matrix[9]);
+        void setWhitePoint(const Color_XYZ_t &white);
+        bool isSaturated(const RGBC_value_t &value);
+        void removeIR(const RGBC_value_t &value, RGBC_value_t &out);
+        uint32_t getLux(const RGBC_value_t &value);
+        uint16_t getCCT(const RGBC_value_t &value);
+        void toXYZ(const RGBC_value_t &value, Color_XYZ_t &xyz);
+        void toLab(const RGBC_value_t &value, Color_Lab_t &lab);
+        void toLab(const Color_XYZ_t &xyz, Color_Lab_t &lab);
+        void toHSV(const RGBC_value_t &value, Color_HSV_t &hsv);
+        void getLux(const RGBC_value_t *values, uint32_t *lux, uint16_t count);
+        void getCCT(const RGBC_value_t *values, uint16_t *cct, uint16_t count);
+        void toXYZ(const RGBC_value_t *values, Color_XYZ_t *xyz, uint16_t count);
+        void toLab(const RGBC_value_t *values, Color_Lab_t *lab, uint16_t count);
+        void toHSV(const RGBC_value_t *values, Color_HSV_t *hsv, uint16_t count);
+
+    private:
+        static int32_t labFunction(uint32_t ratio);
+
+        /* RGB to XYZ matrix, row-major, Q12 */
+        int16_t matrix[9];
+        Color_XYZ_t white;
+        uint16_t saturation = 0;
+        /* Counts to lux factor as 16-bit mantissa and shift */
+        uint16_t luxMul = 0;
+        uint8_t luxShift = 0;
+};
+
+#endif /* GEEGROW_TCS34725_COLOR_H */
\ No newline at end of file
@@ -0,0 +1,199 @@
+/*!
+ * @file Geegrow_TCS34725_Filter.cpp
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Geegrow_TCS34725_Filter.h"
+
+/* Channel of sample by index in order red, green, blue, clear */
+static uint16_t getChannel(const RGBC_value_t &value, uint8_t i) {
+    switch (i) {
+        case 0: return value.red;
+        case 1: return value.green;
+        case 2: return value.blue;
+        default: return value.clear;
+    }
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets filter mode and restarts filter
+    @param    mode    One of FILTER_* values
+    @param    param   Window length for box and median filters (clamped to
+                      size of window), N of alpha = 1 / 2^N for EMA
+    @note     Box and median modes fall back to FILTER_NONE on filter
+              without window
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Filter::setMode(uint8_t mode, uint8_t param) {
+    if ((mode == FILTER_BOX || mode == FILTER_MEDIAN) && param > this->windowSize)
+        param = this->windowSize;
+    if (mode == FILTER_EMA && param > 15)
+        param = 15;
+    if (param == 0 && mode != FILTER_EMA)
+        mode = FILTER_NONE;
+    this->mode = mode;
+    this->param = param;
+    this->reset();
+}
+
+/******************************************************************************/
+/*!
+    @brief    Drops filter history and statistics
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Filter::reset() {
+    this->windowPos = 0;
+    this->windowFill = 0;
+    this->count = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        this->windowSum[i] = 0;
+        this->ema[i] = 0;
+        this->origin[i] = 0;
+        this->sum[i] = 0;
+        this->sumSq[i] = 0;
+    }
+}
+
+/******************************************************************************/
+/*!
+    @brief    Updates statistics with sample and replaces it with filter output
+    @param    value   Reference to structure with RGBC values
+    @note     Output of box and median filters is delayed by half of window
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Filter::apply(RGBC_value_t &value) {
+    uint16_t *ch[4] = {&value.red, &value.green, &value.blue, &value.clear};
+
+    /* Running statistics of input */
+    if (this->count < 0xFFFFFFFF)
+        this->count++;
+    for (uint8_t i = 0; i < 4; i++) {
+        /* Deviations from the first sample keep sums small and exact */
+        if (this->count == 1)
+            this->origin[i] = *ch[i];
+        int32_t d = (int32_t)*ch[i] - this->origin[i];
+        uint32_t a = (d < 0) ? -d : d;
+        this->sum[i] += d;
+        this->sumSq[i] += a * a;
+    }
+
+    switch (this->mode) {
+        case FILTER_BOX: {
+            const RGBC_value_t &old = this->window[this->windowPos];
+            bool full = this->windowFill == this->param;
+            for (uint8_t i = 0; i < 4; i++) {
+                if (full)
+                    this->windowSum[i] -= getChannel(old, i);
+                this->windowSum[i] += *ch[i];
+            }
+            this->window[this->windowPos] = value;
+            this->windowPos = (this->windowPos + 1) % this->param;
+            if (!full)
+                this->windowFill++;
+            for (uint8_t i = 0; i < 4; i++)
+                *ch[i] = (this->windowSum[i] + this->windowFill / 2) / this->windowFill;
+            break;
+        }
+        case FILTER_EMA:
+            /* S += x - S / 2^N keeps all fraction bits alpha needs, output
+               S / 2^N settles exactly on constant input */
+            for (uint8_t i = 0; i < 4; i++) {
+                if (this->count == 1)
+                    this->ema[i] = (int32_t)*ch[i] << this->param;
+                else
+                    this->ema[i] += (int32_t)*ch[i] - (this->ema[i] >> this->param);
+                *ch[i] = this->ema[i] >> this->param;
+            }
+            break;
+        case FILTER_MEDIAN: {
+            this->window[this->windowPos] = value;
+            this->windowPos = (this->windowPos + 1) % this->param;
+            if (this->windowFill < this->param)
+                this->windowFill++;
+            /* Middle element of window is the one with as many smaller
+               elements before it as given by its rank, no copy is sorted */
+            uint8_t rank = this->windowFill / 2;
+            for (uint8_t i = 0; i < 4; i++) {
+                for (uint8_t n = 0; n < this->windowFill; n++) {
+                    uint16_t v = getChannel(this->window[n], i);
+                    uint8_t less = 0, equal = 0;
+                    for (uint8_t k = 0; k < this->windowFill; k++) {
+                        uint16_t w = getChannel(this->window[k], i);
+                        less += (w < v);
+                        equal += (w == v);
+                    }
+                    if (less <= rank && rank < less + equal) {
+                        *ch[i] = v;
+                        break;
+                    }
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get number of samples since reset
+    @return   Number of samples
+ */
+/******************************************************************************/
+uint32_t Geegrow_TCS34725_Filter::getCount() {
+    return this->count;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get running mean of input samples since reset
+    @param    mean    Reference to structure for mean values
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Filter::getMean(RGBC_value_t &mean) {
+    uint16_t *ch[4] = {&mean.red, &mean.green, &mean.blue, &mean.clear};
+    for (uint8_t i = 0; i < 4; i++) {
+        if (this->count == 0) {
+            *ch[i] = 0;
+            continue;
+        }
+        /* Rounded to nearest count */
+        uint64_t a = (this->sum[i] < 0) ? -this->sum[i] : this->sum[i];
+        int32_t q = (a + this->count / 2) / this->count;
+        *ch[i] = this->origin[i] + ((this->sum[i] < 0) ? -q : q);
+    }
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get running sample variance of input samples since reset
+    @param    variance    Array for variance of red, green, blue and clear,
+                          squared counts
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Filter::getVariance(uint32_t variance[4]) {
+    for (uint8_t i = 0; i < 4; i++) {
+        if (this->count < 2) {
+            variance[i] = 0;
+            continue;
+        }
+        /* sum^2 / count split into parts which fit into 64 bits */
+        uint64_t a = (this->sum[i] < 0) ? -this->sum[i] : this->sum[i];
+        uint64_t q = a / this->count;
+        uint64_t r = a % this->count;
+        uint64_t square = q * a + q * r + r * r / this->count;
+        uint64_t m2 = (this->sumSq[i] > square) ? this->sumSq[i] - square : 0;
+        variance[i] = m2 / (this->count - 1);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+/*!
+ * @file Geegrow_TCS34725_Filter.h
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef GEEGROW_TCS34725_FILTER_H
+#define GEEGROW_TCS34725_FILTER_H
+
+#include <Arduino.h>
+#include "Geegrow_TCS34725_Types.h"
+
+/* Filter modes */
+#define FILTER_NONE      0    /* Samples are passed unchanged */
+#define FILTER_BOX       1    /* Average of last N samples */
+#define FILTER_EMA       2    /* Exponential moving average, alpha = 1 / 2^N */
+#define FILTER_MEDIAN    3    /* Median of last N samples */
+
+/******************************************************************************/
+/*!
+    @brief    Integer-only filter of RGBC samples with running statistics
+    @note     Box and median filters keep last samples in window given by
+              caller, their length is limited by size of window. Filter
+              without window runs EMA and statistics only
+ */
+/******************************************************************************/
+class Geegrow_TCS34725_Filter {
+    public:
+        Geegrow_TCS34725_Filter() {}
+        Geegrow_TCS34725_Filter(RGBC_value_t *window, uint8_t size)
+            : window(window), windowSize(size) {
+        }
+        void setMode(uint8_t mode, uint8_t param);
+        void reset();
+        void apply(RGBC_value_t &value);
+        uint32_t getCount();
+        void getMean(RGBC_value_t &mean);
+        void getVariance(uint32_t variance[4]);
+
+    private:
+        uint8_t mode = FILTER_NONE;
+        uint8_t param = 0;
+
+        /* Last samples for box and median filters, owned by caller */
+        RGBC_value_t *window = nullptr;
+        uint8_t windowSize = 0;
+        uint8_t windowPos = 0;
+        uint8_t windowFill = 0;
+        uint32_t windowSum[4] = {0, 0, 0, 0};
+
+        /* State of exponential average scaled by 2^N, exact in steady state */
+        int32_t ema[4] = {0, 0, 0, 0};
+
+        /* Sums of deviations from the first sample and of their squares,
+           exact and free of division per sample */
+        uint32_t count = 0;
+        uint16_t origin[4] = {0, 0, 0, 0};
+        int64_t sum[4] = {0, 0, 0, 0};
+        uint64_t sumSq[4] = {0, 0, 0, 0};
+};
+
+/******************************************************************************/
+/*!
+    @brief    Filter owning window of SIZE samples
+ */
+/******************************************************************************/
+template<uint8_t SIZE>
+class Geegrow_TCS34725_StaticFilter : public Geegrow_TCS34725_Filter {
+    public:
+        Geegrow_TCS34725_StaticFilter() : Geegrow_TCS34725_Filter(storage, SIZE) {
+        }
+
+    private:
+        RGBC_value_t storage[SIZE];
+};
+
+#endif /* GEEGROW_TCS34725_FILTER_H */
\ No newline at end of file
@@ -0,0 +1,289 @@
+/*!
+ * @file Geegrow_TCS34725_Palette.cpp
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "Geegrow_TCS34725_Palette.h"
+
+/******************************************************************************/
+/*!
+    @brief    Removes all reference colors
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Palette::clear() {
+    this->size = 0;
+    this->built = false;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Adds reference color of the next class
+    @param    red     Red component in 255 format
+    @param    green   Green component in 255 format
+    @param    blue    Blue component in 255 format
+    @return   Class id, PALETTE_REJECT if palette is full
+    @note     Colors may be captured by getRGB_255() of calibrated sensor, so
+              classification works in the same space as samples. Call build()
+              after the last color is added
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_Palette::add(uint8_t red, uint8_t green, uint8_t blue) {
+    if (this->size >= this->capacity || this->size >= PALETTE_REJECT)
+        return PALETTE_REJECT;
+    this->colors[this->size][0] = red;
+    this->colors[this->size][1] = green;
+    this->colors[this->size][2] = blue;
+    this->built = false;
+    return this->size++;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get number of classes
+    @return   Number of reference colors
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_Palette::getSize() {
+    return this->size;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get largest number of classes
+    @return   Number of reference colors palette storage takes
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_Palette::getCapacity() {
+    return this->capacity;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sets conditions to reject a sample
+    @param    maxDistance     Largest distance to the nearest reference color
+    @param    minMargin       Smallest difference of distances to the nearest
+                              and the second nearest reference colors
+    @note     Distances are Euclidean in 255 format. Default values accept
+              any sample
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_Palette::setReject(uint8_t maxDistance, uint8_t minMargin) {
+    this->maxDistance = maxDistance;
+    this->minMargin = minMargin;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Precomputes lists of candidate classes of every cell
+    @return   True if lists fit into storage, else palette rejects every
+              sample until it is built again
+    @note     Class is left out of a cell if it is farther from the cell
+              than two other classes are from any point of it. Takes
+              2 * size * 2^(3 * bits) distance calculations, do it once
+              after palette is loaded
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725_Palette::build() {
+    const uint8_t shift = 8 - this->bits;
+    const int16_t width = 1 << shift;
+    const uint8_t mask = (1 << this->bits) - 1;
+    const uint16_t cellCount = 1U << (3 * this->bits);
+    uint16_t length = 0;
+    this->maxCandidates = 0;
+    for (uint16_t cell = 0; cell < cellCount; cell++) {
+        int16_t low[3] = {
+            (int16_t)(((cell >> (2 * this->bits)) & mask) << shift),
+            (int16_t)(((cell >> this->bits) & mask) << shift),
+            (int16_t)((cell & mask) << shift)
+        };
+        /* Two lowest distances to the farthest point of cell bound distance
+           to the second nearest class from any point of it */
+        uint32_t far1 = 0xFFFFFFFF, far2 = 0xFFFFFFFF;
+        for (uint8_t i = 0; i < this->size; i++) {
+            uint32_t d = getFarDistance(this->colors[i], low, width);
+            if (d < far1) {
+                far2 = far1;
+                far1 = d;
+            } else if (d < far2) {
+                far2 = d;
+            }
+        }
+        if (length < this->listSize)
+            this->cells[cell] = length;
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < this->size; i++) {
+            if (getBoxDistance(this->colors[i], low, width) > far2)
+                continue;
+            if (length < this->listSize)
+                this->list[length] = i;
+            length++;
+            n++;
+        }
+        if (n > this->maxCandidates)
+            this->maxCandidates = n;
+    }
+    this->listLength = length;
+    this->built = length <= this->listSize;
+    if (this->built)
+        this->cells[cellCount] = length;
+    return this->built;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get total length of candidate lists
+    @return   Number of list entries the last build() needed
+ */
+/******************************************************************************/
+uint16_t Geegrow_TCS34725_Palette::getListLength() {
+    return this->listLength;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get length of the longest candidate list
+    @return   Largest number of classes classify() checks per sample
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_Palette::getMaxCandidates() {
+    return this->maxCandidates;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Finds class of color
+    @param    red     Red component in 255 format
+    @param    green   Green component in 255 format
+    @param    blue    Blue component in 255 format
+    @param    margin  Reference to difference of distances to the nearest and
+                      the second nearest classes, 255 with a single class
+    @return   Class id, PALETTE_REJECT for ambiguous or too distant colors
+    @note     Only candidates of the cell are checked, the nearest and the
+              second nearest classes are always among them
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_Palette::classify(int16_t red, int16_t green, int16_t blue, uint8_t &margin) {
+    margin = 0;
+    if (!this->built || this->size == 0)
+        return PALETTE_REJECT;
+    red   = constrain(red, 0, 255);
+    green = constrain(green, 0, 255);
+    blue  = constrain(blue, 0, 255);
+    const uint8_t shift = 8 - this->bits;
+    uint16_t cell = ((uint16_t)(red >> shift) << (2 * this->bits)) |
+                    ((uint16_t)(green >> shift) << this->bits) |
+                    (blue >> shift);
+
+    uint8_t best = PALETTE_REJECT;
+    uint32_t bestDist = 0xFFFFFFFF, secondDist = 0xFFFFFFFF;
+    for (uint16_t j = this->cells[cell]; j < this->cells[cell + 1]; j++) {
+        uint8_t id = this->list[j];
+        uint32_t d = getDistance(this->colors[id], red, green, blue);
+        if (d < bestDist) {
+            secondDist = bestDist;
+            bestDist = d;
+            best = id;
+        } else if (d < secondDist) {
+            secondDist = d;
+        }
+    }
+
+    uint16_t bestRoot = sqrt32(bestDist);
+    uint16_t secondRoot = (secondDist == 0xFFFFFFFF) ? 0xFFFF : sqrt32(secondDist);
+    uint16_t m = secondRoot - bestRoot;
+    margin = (m > 0xFF) ? 0xFF : m;
+    if (bestRoot > this->maxDistance || margin < this->minMargin)
+        return PALETTE_REJECT;
+    return best;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get squared Euclidean distance between colors
+    @param    color   Pointer to reference color
+    @param    red     Red component of sample
+    @param    green   Green component of sample
+    @param    blue    Blue component of sample
+    @return   Squared distance
+ */
+/******************************************************************************/
+uint32_t Geegrow_TCS34725_Palette::getDistance(const uint8_t *color, int16_t red, int16_t green, int16_t blue) {
+    int32_t dr = red - color[0];
+    int32_t dg = green - color[1];
+    int32_t db = blue - color[2];
+    return dr * dr + dg * dg + db * db;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get squared Euclidean distance from color to cell
+    @param    color   Pointer to reference color
+    @param    low     Pointer to lowest components of cell
+    @param    width   Width of cell
+    @return   Squared distance, 0 if color is inside cell
+ */
+/******************************************************************************/
+uint32_t Geegrow_TCS34725_Palette::getBoxDistance(const uint8_t *color, const int16_t *low, int16_t width) {
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        int32_t d = 0;
+        if (color[i] < low[i])
+            d = low[i] - color[i];
+        else if (color[i] > low[i] + width - 1)
+            d = color[i] - (low[i] + width - 1);
+        sum += d * d;
+    }
+    return sum;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get squared Euclidean distance from color to the farthest point
+              of cell
+    @param    color   Pointer to reference color
+    @param    low     Pointer to lowest components of cell
+    @param    width   Width of cell
+    @return   Squared distance
+ */
+/******************************************************************************/
+uint32_t Geegrow_TCS34725_Palette::getFarDistance(const uint8_t *color, const int16_t *low, int16_t width) {
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        int32_t d = color[i] - low[i];
+        int32_t e = low[i] + width - 1 - color[i];
+        if (d < 0)
+            d = -d;
+        if (e < 0)
+            e = -e;
+        if (e > d)
+            d = e;
+        sum += d * d;
+    }
+    return sum;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Bitwise integer square root
+    @param    value   Argument
+    @return   Square root rounded down
+ */
+/******************************************************************************/
+uint16_t Geegrow_TCS34725_Palette::sqrt32(uint32_t value) {
+    uint32_t root = 0;
+    for (int8_t bit = 15; bit >= 0; bit--) {
+        uint32_t t = root | (1UL << bit);
+        if (t * t <= value)
+            root = t;
+    }
+    return root;
+}
\ No newline at end of file
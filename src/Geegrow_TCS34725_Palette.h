@@ -0,0 +1,101 @@
+/*!
+ * @file Geegrow_TCS34725_Palette.h
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef GEEGROW_TCS34725_PALETTE_H
+#define GEEGROW_TCS34725_PALETTE_H
+
+#include <Arduino.h>
+
+/* Class id of ambiguous or unknown samples */
+#define PALETTE_REJECT         0xFF
+
+/* Largest bits per channel of lookup table */
+#define PALETTE_MAX_LUT_BITS   5
+
+/******************************************************************************/
+/*!
+    @brief    Nearest reference color classifier with lookup table
+    @note     Reference colors, cell index of 2^(3 * bits) + 1 entries and
+              list of candidate classes are owned by caller. A class is a
+              candidate of a cell unless two other classes are nearer to
+              every point of the cell, so lookup checks only the list of the
+              cell and its result is exact. Lists stay short while there
+              are about 8 cells per class, so larger palettes need more
+              bits per channel
+ */
+/******************************************************************************/
+class Geegrow_TCS34725_Palette {
+    public:
+        Geegrow_TCS34725_Palette(uint8_t (*colors)[3], uint8_t capacity, uint8_t bits,
+                                 uint16_t *cells, uint8_t *list, uint16_t listSize)
+            : colors(colors), capacity(capacity), bits(bits), cells(cells),
+              list(list), listSize(listSize) {
+        }
+        void clear();
+        uint8_t add(uint8_t red, uint8_t green, uint8_t blue);
+        uint8_t getSize();
+        uint8_t getCapacity();
+        void setReject(uint8_t maxDistance, uint8_t minMargin);
+        bool build();
+        uint16_t getListLength();
+        uint8_t getMaxCandidates();
+        uint8_t classify(int16_t red, int16_t green, int16_t blue, uint8_t &margin);
+
+    private:
+        static uint32_t getDistance(const uint8_t *color, int16_t red, int16_t green, int16_t blue);
+        static uint32_t getBoxDistance(const uint8_t *color, const int16_t *low, int16_t width);
+        static uint32_t getFarDistance(const uint8_t *color, const int16_t *low, int16_t width);
+        static uint16_t sqrt32(uint32_t value);
+
+        /* Reference colors, owned by caller */
+        uint8_t (*colors)[3] = nullptr;
+        uint8_t capacity = 0;
+        uint8_t size = 0;
+        uint8_t maxDistance = 0xFF;
+        uint8_t minMargin = 0;
+        /* Candidates of cell i are list[cells[i]] to list[cells[i + 1] - 1] */
+        uint8_t bits = 0;
+        uint16_t *cells = nullptr;
+        uint8_t *list = nullptr;
+        uint16_t listSize = 0;
+        uint16_t listLength = 0;
+        uint8_t maxCandidates = 0;
+        bool built = false;
+};
+
+/******************************************************************************/
+/*!
+    @brief    Palette owning storage for CLASSES colors, lookup table of BITS
+              per channel and LIST candidates in total
+    @note     Every class in every cell, CLASSES * 2^(3 * BITS), always fits.
+              build() returns false if the palette needs a longer list, see
+              getListLength()
+ */
+/******************************************************************************/
+template<uint8_t CLASSES, uint8_t BITS, uint16_t LIST>
+class Geegrow_TCS34725_StaticPalette : public Geegrow_TCS34725_Palette {
+    static_assert(BITS <= PALETTE_MAX_LUT_BITS, "Lookup table is too large");
+
+    public:
+        Geegrow_TCS34725_StaticPalette()
+            : Geegrow_TCS34725_Palette(colorStorage, CLASSES, BITS, cellStorage, listStorage, LIST) {
+        }
+
+    private:
+        uint8_t colorStorage[CLASSES][3];
+        uint16_t cellStorage[(1UL << (3 * BITS)) + 1];
+        uint8_t listStorage[LIST];
+};
+
+#endif /* GEEGROW_TCS34725_PALETTE_H */
\ No newline at end of file
@@ -0,0 +1,89 @@
+/*!
+ * @file Geegrow_TCS34725_RingBuffer.h
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef GEEGROW_TCS34725_RINGBUFFER_H
+#define GEEGROW_TCS34725_RINGBUFFER_H
+
+#include <Arduino.h>
+
+/******************************************************************************/
+/*!
+    @brief    Single-producer/single-consumer ring buffer over given storage
+    @note     Producer only writes head and consumer only writes tail, so one
+              side may run in interrupt context without locking.
+              Size of storage must be a power of two not greater than 128
+ */
+/******************************************************************************/
+template<typename T>
+class Geegrow_TCS34725_RingBuffer {
+    public:
+        Geegrow_TCS34725_RingBuffer(T *storage, uint8_t size)
+            : buffer(storage), mask(size - 1) {
+        }
+
+        /* Stores item, returns false if buffer is full */
+        bool push(const T &item) {
+            uint8_t h = this->head;
+            if ((uint8_t)(h - this->tail) > this->mask)
+                return false;
+            this->buffer[h & this->mask] = item;
+            this->head = h + 1;
+            return true;
+        }
+
+        /* Takes the oldest item, returns false if buffer is empty */
+        bool pop(T &item) {
+            uint8_t t = this->tail;
+            if (t == this->head)
+                return false;
+            item = this->buffer[t & this->mask];
+            this->tail = t + 1;
+            return true;
+        }
+
+        uint8_t available() const {
+            return (uint8_t)(this->head - this->tail);
+        }
+
+        void clear() {
+            this->tail = this->head;
+        }
+
+    private:
+        T *buffer;
+        uint8_t mask;
+        volatile uint8_t head = 0;
+        volatile uint8_t tail = 0;
+};
+
+/******************************************************************************/
+/*!
+    @brief    Ring buffer owning storage of SIZE items
+    @note     SIZE must be a power of two not greater than 128
+ */
+/******************************************************************************/
+template<typename T, uint8_t SIZE>
+class Geegrow_TCS34725_StaticRingBuffer : public Geegrow_TCS34725_RingBuffer<T> {
+    static_assert(SIZE && !(SIZE & (SIZE - 1)) && SIZE <= 128,
+                  "SIZE must be a power of two not greater than 128");
+
+    public:
+        Geegrow_TCS34725_StaticRingBuffer() : Geegrow_TCS34725_RingBuffer<T>(storage, SIZE) {
+        }
+
+    private:
+        T storage[SIZE];
+};
+
+#endif /* GEEGROW_TCS34725_RINGBUFFER_H */
\ No newline at end of file
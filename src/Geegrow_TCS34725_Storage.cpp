@@ -0,0 +1,309 @@
+/*!
+ * @file Geegrow_TCS34725_Storage.cpp
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ * Calibration blob layout, little-endian:
+ *   'G' 'C' | version | ATIME | gain | rows | rows * {C, R, G, B} | CRC-16
+ * CRC-16/CCITT-FALSE covers all preceding bytes.
+ */
+
+#include "Geegrow_TCS34725.h"
+#if TCS34725_HAS_EEPROM
+#include <EEPROM.h>
+#endif
+
+#define CALIB_BLOB_HEADER_SIZE   6
+#define CALIB_BLOB_ROW_SIZE      8
+#define CALIB_BLOB_CRC_SIZE      2
+
+/******************************************************************************/
+/*!
+    @brief    Updates CRC-16/CCITT-FALSE with one byte
+    @param    crc     Current value of CRC
+    @param    value   Next byte
+    @return   New value of CRC
+ */
+/******************************************************************************/
+static uint16_t crc16_update(uint16_t crc, uint8_t value) {
+    crc ^= (uint16_t)value << 8;
+    for (uint8_t i = 0; i < 8; i++)
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    return crc;
+}
+
+struct BufferContext {
+    uint8_t *buf;
+    uint16_t len;
+};
+
+static bool bufferWriter(void *ctx, uint16_t index, uint8_t value) {
+    BufferContext *c = (BufferContext*)ctx;
+    if (index >= c->len)
+        return false;
+    c->buf[index] = value;
+    return true;
+}
+
+static int16_t bufferReader(void *ctx, uint16_t index) {
+    BufferContext *c = (BufferContext*)ctx;
+    return (index < c->len) ? c->buf[index] : -1;
+}
+
+static bool printWriter(void *ctx, uint16_t index, uint8_t value) {
+    (void)index;
+    return ((Print*)ctx)->write(value) == 1;
+}
+
+static int16_t streamReader(void *ctx, uint16_t index) {
+    (void)index;
+    uint8_t value;
+    return ((Stream*)ctx)->readBytes(&value, 1) == 1 ? value : -1;
+}
+
+#if TCS34725_HAS_EEPROM
+static bool eepromWriter(void *ctx, uint16_t index, uint8_t value) {
+    uint16_t address = *(uint16_t*)ctx + index;
+    if (address >= EEPROM.length())
+        return false;
+    EEPROM.update(address, value);
+    return true;
+}
+
+static int16_t eepromReader(void *ctx, uint16_t index) {
+    uint16_t address = *(uint16_t*)ctx + index;
+    return (address < EEPROM.length()) ? EEPROM.read(address) : -1;
+}
+#endif
+
+/******************************************************************************/
+/*!
+    @brief    Get size of calibration blob for current table
+    @return   Size in bytes, 0 if table has less than MIN_CALIB_TABLE_SIZE rows
+ */
+/******************************************************************************/
+uint16_t Geegrow_TCS34725::getCalibrationBlobSize() {
+    if (this->calibTableSize < MIN_CALIB_TABLE_SIZE)
+        return 0;
+    return CALIB_BLOB_HEADER_SIZE + CALIB_BLOB_ROW_SIZE * this->calibTableSize + CALIB_BLOB_CRC_SIZE;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Serializes calibration table to buffer
+    @param    buf     Pointer to buffer
+    @param    len     Size of buffer
+    @return   Number of written bytes, 0 on error
+ */
+/******************************************************************************/
+uint16_t Geegrow_TCS34725::exportCalibration(uint8_t *buf, uint16_t len) {
+    BufferContext ctx = {buf, len};
+    return this->encodeCalibration(bufferWriter, &ctx);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Loads calibration table from buffer
+    @param    buf     Pointer to buffer
+    @param    len     Size of buffer
+    @return   True if blob is valid and table was replaced
+    @note     Calibration started by beginCalibration() is cancelled when
+              table is replaced, so it can't overwrite loaded table later
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725::importCalibration(const uint8_t *buf, uint16_t len) {
+    BufferContext ctx = {(uint8_t*)buf, len};
+    /* Buffer is read twice, so validated rows are decoded into the table */
+    if (!this->decodeCalibration(bufferReader, &ctx, nullptr, 0))
+        return false;
+    this->cancelCalibration();
+    uint8_t size = this->decodeCalibration(bufferReader, &ctx, this->calibValues, this->calibCapacity);
+    this->loadTable(this->calibValues, size);
+    return true;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Writes calibration blob to output, e.g. a file on SD card
+    @param    out     Reference to output
+    @return   Number of written bytes, 0 on error
+ */
+/******************************************************************************/
+uint16_t Geegrow_TCS34725::writeCalibration(Print &out) {
+    return this->encodeCalibration(printWriter, &out);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Reads calibration blob from input, e.g. a file on SD card
+    @param    in          Reference to input
+    @param    staging     Pointer to array for rows read from input
+    @param    size        Number of elements in staging array
+    @return   True if blob is valid and table was replaced
+    @note     Stream can't be read twice, so rows are collected in staging
+              array and table is replaced only after the whole blob is
+              checked. Damaged blob leaves current table unchanged. Blob with
+              more rows than staging array or table holds is rejected.
+              Calibration started by beginCalibration() is cancelled when
+              table is replaced
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725::readCalibration(Stream &in, RGBC_value_t *staging, uint8_t size) {
+    if (!staging)
+        return false;
+    if (size > this->calibCapacity)
+        size = this->calibCapacity;
+    uint8_t rows = this->decodeCalibration(streamReader, &in, staging, size);
+    if (rows == 0)
+        return false;
+    this->cancelCalibration();
+    this->loadTable(staging, rows);
+    return true;
+}
+
+#if TCS34725_HAS_EEPROM
+/******************************************************************************/
+/*!
+    @brief    Stores calibration blob in EEPROM
+    @param    address     Address of the first byte in EEPROM
+    @return   True on success
+    @note     Only changed bytes are written to save EEPROM endurance
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725::saveCalibration(uint16_t address) {
+    return this->encodeCalibration(eepromWriter, &address) != 0;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Loads calibration blob from EEPROM
+    @param    address     Address of the first byte in EEPROM
+    @return   True if blob is valid and table was replaced
+    @note     Calibration started by beginCalibration() is cancelled when
+              table is replaced
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725::loadCalibration(uint16_t address) {
+    if (!this->decodeCalibration(eepromReader, &address, nullptr, 0))
+        return false;
+    this->cancelCalibration();
+    uint8_t size = this->decodeCalibration(eepromReader, &address, this->calibValues, this->calibCapacity);
+    this->loadTable(this->calibValues, size);
+    return true;
+}
+#endif
+
+/******************************************************************************/
+/*!
+    @brief    Serializes calibration table byte by byte
+    @param    writer  Function storing one byte
+    @param    ctx     Context of writer
+    @return   Number of written bytes, 0 on error
+    @note     Table of less than MIN_CALIB_TABLE_SIZE rows is not written, it
+              couldn't be loaded back
+ */
+/******************************************************************************/
+uint16_t Geegrow_TCS34725::encodeCalibration(ByteWriter writer, void *ctx) {
+    if (this->calibTableSize < MIN_CALIB_TABLE_SIZE)
+        return 0;
+    /* Table is valid for configuration it was taken with */
+    const uint8_t header[CALIB_BLOB_HEADER_SIZE] = {
+        'G', 'C', CALIB_BLOB_VERSION,
+        this->autoRange ? this->refATIME : this->currentATIME,
+        this->autoRange ? this->refGain : this->currentGain,
+        this->calibTableSize
+    };
+    uint16_t crc = 0xFFFF;
+    uint16_t index = 0;
+    for (uint8_t i = 0; i < CALIB_BLOB_HEADER_SIZE; i++, index++) {
+        if (!writer(ctx, index, header[i]))
+            return 0;
+        crc = crc16_update(crc, header[i]);
+    }
+    for (uint8_t row = 0; row < this->calibTableSize; row++) {
+        const RGBC_value_t &v = this->calibValues[row];
+        const uint16_t ch[4] = {v.clear, v.red, v.green, v.blue};
+        for (uint8_t i = 0; i < 4; i++) {
+            for (uint8_t b = 0; b < 2; b++, index++) {
+                uint8_t value = ch[i] >> (8 * b);
+                if (!writer(ctx, index, value))
+                    return 0;
+                crc = crc16_update(crc, value);
+            }
+        }
+    }
+    if (!writer(ctx, index++, crc & 0xFF) || !writer(ctx, index++, crc >> 8))
+        return 0;
+    return index;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Parses and checks calibration blob
+    @param    reader  Function returning one byte, or -1 at the end of data
+    @param    ctx     Context of reader
+    @param    rows    Pointer to array for decoded rows, nullptr to only
+                      validate blob
+    @param    size    Number of elements in rows array
+    @return   Number of rows in valid blob, 0 if blob is rejected
+    @note     Blob is rejected if it is damaged, has another format version,
+              was taken with another integration time or gain, has rows out
+              of clear order or doesn't fit into rows array or table. Rows
+              array may be written even if blob turns out to be rejected
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725::decodeCalibration(ByteReader reader, void *ctx, RGBC_value_t *rows, uint8_t size) {
+    uint8_t header[CALIB_BLOB_HEADER_SIZE];
+    uint16_t crc = 0xFFFF;
+    uint16_t index = 0;
+    for (uint8_t i = 0; i < CALIB_BLOB_HEADER_SIZE; i++, index++) {
+        int16_t value = reader(ctx, index);
+        if (value < 0)
+            return 0;
+        header[i] = value;
+        crc = crc16_update(crc, value);
+    }
+    if (header[0] != 'G' || header[1] != 'C' || header[2] != CALIB_BLOB_VERSION)
+        return 0;
+    if (header[3] != (this->autoRange ? this->refATIME : this->currentATIME) ||
+        header[4] != (this->autoRange ? this->refGain : this->currentGain))
+        return 0;
+    uint8_t count = header[5];
+    if (count < MIN_CALIB_TABLE_SIZE || count > this->calibCapacity || (rows && count > size))
+        return 0;
+
+    uint16_t lastClear = 0xFFFF;
+    for (uint8_t row = 0; row < count; row++) {
+        uint16_t ch[4];
+        for (uint8_t i = 0; i < 4; i++) {
+            int16_t lo = reader(ctx, index++);
+            int16_t hi = reader(ctx, index++);
+            if (lo < 0 || hi < 0)
+                return 0;
+            crc = crc16_update(crc16_update(crc, lo), hi);
+            ch[i] = ((uint16_t)hi << 8) | lo;
+        }
+        /* Table is written sorted from MAX to MIN clear value */
+        if (ch[0] > lastClear)
+            return 0;
+        lastClear = ch[0];
+        if (rows) {
+            rows[row].clear = ch[0];
+            rows[row].red   = ch[1];
+            rows[row].green = ch[2];
+            rows[row].blue  = ch[3];
+        }
+    }
+    int16_t lo = reader(ctx, index++);
+    int16_t hi = reader(ctx, index++);
+    if (lo < 0 || hi < 0 || crc != (((uint16_t)hi << 8) | lo))
+        return 0;
+    return count;
+}
@@ -0,0 +1,115 @@
+/*!
+ * @file Geegrow_TCS34725_Timing.h
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef GEEGROW_TCS34725_TIMING_H
+#define GEEGROW_TCS34725_TIMING_H
+
+#include <Arduino.h>
+#include "defines.h"
+
+/* Duration of one integration or wait step, us */
+#define TCS34725_CYCLE_US      2400UL
+
+/******************************************************************************/
+/*!
+    @brief    Get number of integration cycles
+    @param    atime   Value of ATIME register, 0 means 256 cycles
+    @return   Number of cycles (1..256)
+ */
+/******************************************************************************/
+constexpr uint16_t TCS34725_cycles(uint8_t atime) {
+    return 256 - atime;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get value of ATIME register for number of cycles
+    @param    cycles  Number of integration cycles, clamped to 1..256
+    @return   Value of ATIME register
+ */
+/******************************************************************************/
+constexpr uint8_t TCS34725_atime(uint16_t cycles) {
+    return (uint8_t)(256 - (cycles < 1 ? 1 : (cycles > 256 ? 256 : cycles)));
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get duration of integration state
+    @param    atime   Value of ATIME register
+    @return   Integration time in microseconds
+ */
+/******************************************************************************/
+constexpr uint32_t TCS34725_integrationTime_us(uint8_t atime) {
+    return TCS34725_CYCLE_US * TCS34725_cycles(atime);
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get the longest ATIME register value fitting into given time
+    @param    us      Integration time in microseconds
+    @return   Value of ATIME register, at least 1 cycle is used
+ */
+/******************************************************************************/
+constexpr uint8_t TCS34725_atimeFor_us(uint32_t us) {
+    return TCS34725_atime(us / TCS34725_CYCLE_US > 256 ? 256 : (uint16_t)(us / TCS34725_CYCLE_US));
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get maximal count of RGBC channels
+    @param    cycles  Number of integration cycles
+    @return   Saturation level, 1024 counts per cycle up to 65535
+ */
+/******************************************************************************/
+constexpr uint16_t TCS34725_saturation(uint16_t cycles) {
+    return (cycles >= 64) ? 0xFFFF : 1024 * cycles;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get counts per integration cycle relative to 1x gain
+    @param    gain    Value of CONTROL register
+    @param    cycles  Number of integration cycles
+    @return   Product of gain factor and cycles
+ */
+/******************************************************************************/
+constexpr uint16_t TCS34725_sensitivity(uint8_t gain, uint16_t cycles) {
+    return ((gain & 0x03) == RN_CONTROL_GAIN_60X ? 60 :
+            (gain & 0x03) == RN_CONTROL_GAIN_16X ? 16 :
+            (gain & 0x03) == RN_CONTROL_GAIN_4X ? 4 : 1) * cycles;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Configuration fixed at compile time
+    @note     All timing and saturation constants fold to literals, e.g.
+              Geegrow_TCS34725_Config<TCS34725_atimeFor_us(50000), RN_CONTROL_GAIN_4X>
+              gives 20 cycles, 48 ms integration time and 20480 counts of
+              saturation. Pass it to constructor or setConfig() of driver,
+              so thresholds derived from it match the device
+ */
+/******************************************************************************/
+template<uint8_t ATIME, uint8_t GAIN>
+struct Geegrow_TCS34725_Config {
+    static_assert(GAIN <= RN_CONTROL_GAIN_60X, "GAIN must be one of RN_CONTROL_GAIN_* values");
+
+    static constexpr uint8_t atime = ATIME;
+    static constexpr uint8_t gain = GAIN;
+    static constexpr uint16_t cycles = TCS34725_cycles(ATIME);
+    static constexpr uint32_t integrationTime_us = TCS34725_integrationTime_us(ATIME);
+    static constexpr uint16_t saturation = TCS34725_saturation(TCS34725_cycles(ATIME));
+    static constexpr uint16_t sensitivity = TCS34725_sensitivity(GAIN, TCS34725_cycles(ATIME));
+};
+
+#endif /* GEEGROW_TCS34725_TIMING_H */
\ No newline at end of file
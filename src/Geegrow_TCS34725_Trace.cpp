@@ -0,0 +1,380 @@
+/*!
+ * @file Geegrow_TCS34725_Trace.cpp
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+/*
+ * Trace format: 'G', 'T', TRACE_VERSION, then records. Every record is its
+ * type byte followed by varint of time since previous record, in us.
+ * TRACE_SAMPLE continues with zigzag varints of differences of R, G, B, C
+ * from previous sample, TRACE_CONFIG with ATIME and gain bytes, TRACE_DROP
+ * with varint of number of lost records and flags byte, bit 0 set if any
+ * of them was TRACE_CONFIG. Varints keep 7 bits per byte, low bits first,
+ * high bit set on all but last byte
+ */
+
+#include "Geegrow_TCS34725_Trace.h"
+#include "Geegrow_TCS34725.h"
+
+/* Longest record: type, time and 4 channel differences */
+#define MAX_RECORD_SIZE    (1 + 5 + 4 * 3)
+/* Drop record: type, zero time, number of records and flags */
+#define MAX_DROP_SIZE      (1 + 1 + 3 + 1)
+
+/* Flags of TRACE_DROP */
+#define DROP_CONFIG_LOST   0x01
+
+/* Channel of sample by index in order red, green, blue, clear */
+static uint16_t *getChannel(RGBC_value_t &value, uint8_t i) {
+    switch (i) {
+        case 0: return &value.red;
+        case 1: return &value.green;
+        case 2: return &value.blue;
+        default: return &value.clear;
+    }
+}
+
+/******************************************************************************/
+/*!
+    @brief    Starts new trace
+    @param    out     Output for trace, e.g. Serial or file on SD card
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_TraceWriter::begin(Print &out) {
+    const uint8_t header[3] = {'G', 'T', TRACE_VERSION};
+    this->out = &out;
+    this->head = 0;
+    this->count = 0;
+    this->lastTime = 0;
+    this->last.red = this->last.green = this->last.blue = this->last.clear = 0;
+    this->dropped = 0;
+    this->pendingDrops = 0;
+    this->pendingConfigLost = false;
+    this->push(header, sizeof(header));
+}
+
+/******************************************************************************/
+/*!
+    @brief    Adds raw sample to trace
+    @param    value   Reference to structure with raw RGBC values
+    @param    time    Time of sample, us
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_TraceWriter::recordSample(const RGBC_value_t &value, uint32_t time) {
+    uint8_t rec[MAX_RECORD_SIZE];
+    uint8_t len = 0;
+    RGBC_value_t v = value;
+    rec[len++] = TRACE_SAMPLE;
+    len += putVarint(rec + len, time - this->lastTime);
+    for (uint8_t i = 0; i < 4; i++) {
+        int32_t delta = (int32_t)*getChannel(v, i) - *getChannel(this->last, i);
+        len += putVarint(rec + len, ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+    }
+    /* Dropped record is skipped by differences of the next one */
+    if (this->push(rec, len)) {
+        this->lastTime = time;
+        this->last = value;
+    }
+}
+
+/******************************************************************************/
+/*!
+    @brief    Adds configuration change to trace
+    @param    atime   Value of ATIME register
+    @param    gain    Value of gain
+    @param    time    Time of change, us
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_TraceWriter::recordConfig(uint8_t atime, uint8_t gain, uint32_t time) {
+    uint8_t rec[MAX_RECORD_SIZE];
+    uint8_t len = 0;
+    rec[len++] = TRACE_CONFIG;
+    len += putVarint(rec + len, time - this->lastTime);
+    rec[len++] = atime;
+    rec[len++] = gain;
+    if (this->push(rec, len))
+        this->lastTime = time;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sends buffered bytes as far as output accepts them at once
+    @note     Call it from main loop. Outputs which don't report free space
+              by availableForWrite() are written by flush() only
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_TraceWriter::poll() {
+    if (!this->out)
+        return;
+    int free = this->out->availableForWrite();
+    while (this->count && free > 0) {
+        uint8_t tail = (this->head + this->bufferSize - this->count) % this->bufferSize;
+        this->out->write(this->buffer[tail]);
+        this->count--;
+        free--;
+    }
+}
+
+/******************************************************************************/
+/*!
+    @brief    Sends all buffered bytes, blocking if output is busy
+ */
+/******************************************************************************/
+void Geegrow_TCS34725_TraceWriter::flush() {
+    if (!this->out)
+        return;
+    while (this->count) {
+        uint8_t tail = (this->head + this->bufferSize - this->count) % this->bufferSize;
+        this->out->write(this->buffer[tail]);
+        this->count--;
+    }
+}
+
+/******************************************************************************/
+/*!
+    @brief    Get number of records lost on full buffer
+    @return   Number of dropped records
+ */
+/******************************************************************************/
+uint16_t Geegrow_TCS34725_TraceWriter::getDropped() {
+    return this->dropped;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Puts whole record to buffer
+    @param    data    Pointer to encoded record
+    @param    len     Length of record
+    @return   False if record doesn't fit and is dropped
+    @note     Records dropped before are reported by TRACE_DROP put in
+              front of this one, both fit or both are dropped
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725_TraceWriter::push(const uint8_t *data, uint8_t len) {
+    uint8_t drop[MAX_DROP_SIZE];
+    uint8_t dropLen = 0;
+    if (this->pendingDrops) {
+        drop[dropLen++] = TRACE_DROP;
+        drop[dropLen++] = 0;
+        dropLen += putVarint(drop + dropLen, this->pendingDrops);
+        drop[dropLen++] = this->pendingConfigLost ? DROP_CONFIG_LOST : 0;
+    }
+    if (!this->out || this->bufferSize - this->count < dropLen + len) {
+        if (this->dropped < 0xFFFF)
+            this->dropped++;
+        if (this->pendingDrops < 0xFFFF)
+            this->pendingDrops++;
+        if (data[0] == TRACE_CONFIG)
+            this->pendingConfigLost = true;
+        return false;
+    }
+    for (uint8_t i = 0; i < dropLen + len; i++) {
+        this->buffer[this->head] = (i < dropLen) ? drop[i] : data[i - dropLen];
+        this->head = (this->head + 1) % this->bufferSize;
+    }
+    this->count += dropLen + len;
+    this->pendingDrops = 0;
+    this->pendingConfigLost = false;
+    return true;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Encodes unsigned varint
+    @param    buf     Pointer to buffer, at least 5 bytes
+    @param    value   Value to be encoded
+    @return   Number of bytes written
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_TraceWriter::putVarint(uint8_t *buf, uint32_t value) {
+    uint8_t len = 0;
+    while (value >= 0x80) {
+        buf[len++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    buf[len++] = value;
+    return len;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Starts reading trace from stream
+    @param    in      Stream with trace
+    @return   True if header is valid
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725_TraceReader::begin(Stream &in) {
+    this->in = &in;
+    this->buf = nullptr;
+    return this->readHeader();
+}
+
+/******************************************************************************/
+/*!
+    @brief    Starts reading trace from memory
+    @param    buf     Pointer to trace
+    @param    len     Length of trace
+    @return   True if header is valid
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725_TraceReader::begin(const uint8_t *buf, uint32_t len) {
+    this->in = nullptr;
+    this->buf = buf;
+    this->len = len;
+    this->pos = 0;
+    return this->readHeader();
+}
+
+/******************************************************************************/
+/*!
+    @brief    Decodes next record
+    @param    record  Reference to structure for record
+    @return   Type of record, TRACE_END or TRACE_ERROR
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_TraceReader::next(TraceRecord_t &record) {
+    int16_t type = this->readByte();
+    if (type < 0)
+        return TRACE_END;
+    uint32_t delta;
+    if (!this->getVarint(delta))
+        return TRACE_ERROR;
+    this->lastTime += delta;
+    record.time = this->lastTime;
+
+    if (type == TRACE_SAMPLE) {
+        for (uint8_t i = 0; i < 4; i++) {
+            uint32_t z;
+            if (!this->getVarint(z))
+                return TRACE_ERROR;
+            int32_t d = (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+            uint16_t *ch = getChannel(this->last, i);
+            *ch = (uint16_t)(*ch + d);
+        }
+        record.value = this->last;
+        return TRACE_SAMPLE;
+    }
+    if (type == TRACE_CONFIG) {
+        int16_t atime = this->readByte();
+        int16_t gain = this->readByte();
+        if (atime < 0 || gain < 0)
+            return TRACE_ERROR;
+        record.atime = atime;
+        record.gain = gain;
+        return TRACE_CONFIG;
+    }
+    if (type == TRACE_DROP) {
+        uint32_t dropped;
+        if (!this->getVarint(dropped) || dropped > 0xFFFF)
+            return TRACE_ERROR;
+        int16_t flags = this->readByte();
+        if (flags < 0)
+            return TRACE_ERROR;
+        record.dropped = dropped;
+        record.configLost = flags & DROP_CONFIG_LOST;
+        return TRACE_DROP;
+    }
+    return TRACE_ERROR;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Feeds trace through processing of driver
+    @param    device      Driver, usually created on Geegrow_TCS34725_NullBus
+    @param    callback    Function called for every sample, may be nullptr
+    @param    samples     Reference to number of replayed samples, without
+                          dropped ones
+    @return   TRACE_END if whole trace is replayed, TRACE_ERROR if it is
+              damaged or writer lost a configuration record
+    @note     Configuration records are applied to driver, samples go through
+              auto-ranging, filter and calibration exactly as if read from
+              device. Processed values match live ones bit for bit if driver
+              is set up as the recording one and no records were dropped.
+              Lost samples only shift filter state, lost configuration would
+              scale every later sample wrongly, so replay stops at it.
+              Replay runs at full speed, time is only reported to callback,
+              so calibration by beginCalibration() is not reproduced
+ */
+/******************************************************************************/
+uint8_t Geegrow_TCS34725_TraceReader::replay(Geegrow_TCS34725 &device, TraceCallback_t callback, uint32_t &samples) {
+    TraceRecord_t record;
+    uint8_t type;
+    samples = 0;
+    while ((type = this->next(record)) != TRACE_END) {
+        if (type == TRACE_ERROR)
+            return TRACE_ERROR;
+        if (type == TRACE_DROP) {
+            if (record.configLost)
+                return TRACE_ERROR;
+        } else if (type == TRACE_CONFIG) {
+            device.setIntegrationTime(record.atime);
+            device.setGain(record.gain);
+        } else {
+            RGBC_value_t value = record.value;
+            /* Clipped samples are dropped by auto-ranging as in live run */
+            if (!device.injectSample(value))
+                continue;
+            if (callback)
+                callback(record.time, record.value, value);
+            samples++;
+        }
+    }
+    return TRACE_END;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Checks signature and version, resets decoder
+    @return   True if header is valid
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725_TraceReader::readHeader() {
+    this->lastTime = 0;
+    this->last.red = this->last.green = this->last.blue = this->last.clear = 0;
+    return this->readByte() == 'G' && this->readByte() == 'T' && this->readByte() == TRACE_VERSION;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Reads one byte of trace
+    @return   Byte value, -1 at the end of trace
+ */
+/******************************************************************************/
+int16_t Geegrow_TCS34725_TraceReader::readByte() {
+    if (this->in) {
+        uint8_t b;
+        return this->in->readBytes(&b, 1) == 1 ? b : -1;
+    }
+    if (this->buf && this->pos < this->len)
+        return this->buf[this->pos++];
+    return -1;
+}
+
+/******************************************************************************/
+/*!
+    @brief    Decodes unsigned varint
+    @param    value   Reference to decoded value
+    @return   False if trace ends inside varint or it is too long
+ */
+/******************************************************************************/
+bool Geegrow_TCS34725_TraceReader::getVarint(uint32_t &value) {
+    value = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        int16_t b = this->readByte();
+        if (b < 0)
+            return false;
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
\ No newline at end of file
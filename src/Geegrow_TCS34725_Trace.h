@@ -0,0 +1,129 @@
+/*!
+ * @file Geegrow_TCS34725_Trace.h
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef GEEGROW_TCS34725_TRACE_H
+#define GEEGROW_TCS34725_TRACE_H
+
+#include <Arduino.h>
+#include "Geegrow_TCS34725_Types.h"
+
+class Geegrow_TCS34725;
+
+/* Format version written after 'G', 'T' signature */
+#define TRACE_VERSION          2
+
+/* Record types, values returned by Geegrow_TCS34725_TraceReader::next() */
+#define TRACE_END              0    /* No more records */
+#define TRACE_SAMPLE           1    /* Raw RGBC sample */
+#define TRACE_CONFIG           2    /* Integration time and gain */
+#define TRACE_DROP             3    /* Records lost by writer before next one */
+#define TRACE_ERROR            0xFF /* Bad header or truncated record */
+
+/******************************************************************************/
+/*!
+    @brief    Decoded record of trace
+ */
+/******************************************************************************/
+struct TraceRecord_t {
+    uint32_t time;          /* micros() when record was made */
+    RGBC_value_t value;     /* Raw values of TRACE_SAMPLE */
+    uint8_t atime;          /* ATIME of TRACE_CONFIG */
+    uint8_t gain;           /* Gain of TRACE_CONFIG */
+    uint16_t dropped;       /* Number of lost records of TRACE_DROP */
+    bool configLost;        /* TRACE_DROP lost a TRACE_CONFIG */
+};
+
+/* Called by replay() for every sample with raw and processed values */
+typedef void (*TraceCallback_t)(uint32_t time, const RGBC_value_t &raw, const RGBC_value_t &value);
+
+/******************************************************************************/
+/*!
+    @brief    Encodes samples and configuration changes to compact trace
+    @note     Records are kept in buffer given by caller, up to 255 bytes,
+              and sent by poll() only as far as output accepts them without
+              blocking. Records not fitting in buffer are dropped, the next
+              record written is preceded by TRACE_DROP with their number
+ */
+/******************************************************************************/
+class Geegrow_TCS34725_TraceWriter {
+    public:
+        Geegrow_TCS34725_TraceWriter(uint8_t *buffer, uint8_t size)
+            : buffer(buffer), bufferSize(size) {
+        }
+        void begin(Print &out);
+        void recordSample(const RGBC_value_t &value, uint32_t time);
+        void recordConfig(uint8_t atime, uint8_t gain, uint32_t time);
+        void poll();
+        void flush();
+        uint16_t getDropped();
+
+    private:
+        bool push(const uint8_t *data, uint8_t len);
+        static uint8_t putVarint(uint8_t *buf, uint32_t value);
+
+        Print *out = nullptr;
+        /* Ring of encoded bytes, owned by caller */
+        uint8_t *buffer = nullptr;
+        uint8_t bufferSize = 0;
+        uint8_t head = 0;
+        uint8_t count = 0;
+        uint32_t lastTime = 0;
+        RGBC_value_t last = {0, 0, 0, 0};
+        uint16_t dropped = 0;
+        /* Records lost since the last written one */
+        uint16_t pendingDrops = 0;
+        bool pendingConfigLost = false;
+};
+
+/******************************************************************************/
+/*!
+    @brief    Trace writer owning buffer of SIZE bytes
+ */
+/******************************************************************************/
+template<uint8_t SIZE>
+class Geegrow_TCS34725_StaticTraceWriter : public Geegrow_TCS34725_TraceWriter {
+    public:
+        Geegrow_TCS34725_StaticTraceWriter() : Geegrow_TCS34725_TraceWriter(storage, SIZE) {
+        }
+
+    private:
+        uint8_t storage[SIZE];
+};
+
+/******************************************************************************/
+/*!
+    @brief    Decodes trace from stream or memory and replays it
+ */
+/******************************************************************************/
+class Geegrow_TCS34725_TraceReader {
+    public:
+        bool begin(Stream &in);
+        bool begin(const uint8_t *buf, uint32_t len);
+        uint8_t next(TraceRecord_t &record);
+        uint8_t replay(Geegrow_TCS34725 &device, TraceCallback_t callback, uint32_t &samples);
+
+    private:
+        bool readHeader();
+        int16_t readByte();
+        bool getVarint(uint32_t &value);
+
+        Stream *in = nullptr;
+        const uint8_t *buf = nullptr;
+        uint32_t len = 0;
+        uint32_t pos = 0;
+        uint32_t lastTime = 0;
+        RGBC_value_t last = {0, 0, 0, 0};
+};
+
+#endif /* GEEGROW_TCS34725_TRACE_H */
\ No newline at end of file
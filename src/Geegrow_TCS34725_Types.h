@@ -0,0 +1,27 @@
+/*!
+ * @file Geegrow_TCS34725_Types.h
+ *
+ * This is a library for the GeeGrow TCS34725 Color Sensor
+ * https://www.geegrow.ru
+ *
+ * @section author Author
+ * Written by Anton Pomazanov
+ *
+ * @section license License
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef GEEGROW_TCS34725_TYPES_H
+#define GEEGROW_TCS34725_TYPES_H
+
+#include <Arduino.h>
+
+struct RGBC_value_t {
+    uint16_t red;
+    uint16_t green;
+    uint16_t blue;
+    uint16_t clear;
+};
+
+#endif /* GEEGROW_TCS34725_TYPES_H */
\ No newline at end of file